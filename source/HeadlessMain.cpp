@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "game/Game.hpp"
+#include "input/null/NullInputManager.hpp"
+#include "util/Profiler.hpp"
+#include "video/null/NullVideoManager.hpp"
+#include "video/software/SoftwareVideoManager.hpp"
+
+#define SCREEN_RESOLUTION_X 320
+#define SCREEN_RESOLUTION_Y 240
+#define DEFAULT_FRAME_COUNT 3600
+
+/**
+ * Program entry point for running the game without a display.
+ *
+ * Usage: JumpHeadless [--level path] [--script seed] [frames] [image]
+ *
+ * Runs the game for the given number of frames as fast as possible, in the
+ * given level file or else the built-in test level, then
+ * reports how long the frames took and a hash of the final simulation state.
+ * If a script seed is given, buttons are pressed by a script generated from
+ * it, so the hash can be compared between builds to check that they simulate
+ * the same game. If an image path is given, the game is rendered in software
+ * and the last frame is saved to it as a PPM image.
+ */
+int main(int argc, char** argv)
+{
+    const char* usage = " [--level path] [--script seed] [frames] [image]\n";
+    std::string levelPath;
+    unsigned long scriptSeed = 0;
+    int arg = 1;
+    for (; argc > arg + 1 && std::strncmp(argv[arg], "--", 2) == 0; arg += 2)
+    {
+        if (std::strcmp(argv[arg], "--level") == 0)
+        {
+            levelPath = argv[arg + 1];
+            continue;
+        }
+        char* end;
+        scriptSeed = std::strtoul(argv[arg + 1], &end, 10);
+        if (std::strcmp(argv[arg], "--script") != 0 || *end != '\0' || scriptSeed == 0)
+        {
+            std::cout << "Usage: " << argv[0] << usage;
+            return -1;
+        }
+    }
+
+    long frameCount = DEFAULT_FRAME_COUNT;
+    if (argc > arg)
+    {
+        char* end;
+        frameCount = std::strtol(argv[arg], &end, 10);
+        if (*end != '\0' || frameCount <= 0)
+        {
+            std::cout << "Usage: " << argv[0] << usage;
+            return -1;
+        }
+    }
+    const char* imagePath = argc > arg + 1 ? argv[arg + 1] : nullptr;
+
+    try
+    {
+        // Setup managers
+        std::unique_ptr<VideoManager> videoManager;
+        SoftwareVideoManager* softwareVideoManager = nullptr;
+        if (imagePath != nullptr)
+        {
+            softwareVideoManager = new SoftwareVideoManager(SCREEN_RESOLUTION_X, SCREEN_RESOLUTION_Y);
+            videoManager.reset(softwareVideoManager);
+        }
+        else
+        {
+            videoManager.reset(new NullVideoManager(SCREEN_RESOLUTION_X, SCREEN_RESOLUTION_Y));
+        }
+        NullInputManager inputManager(frameCount, static_cast<unsigned>(scriptSeed));
+
+        // Run the game
+        auto start = std::chrono::steady_clock::now();
+        Game game(inputManager, *videoManager, levelPath);
+        game.runUnthrottled();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "Simulated " << inputManager.getFrame() << " frames in " << elapsed.count() << " s ("
+                  << inputManager.getFrame() / elapsed.count() << " frames/s)\n";
+        std::cout << "State hash: " << std::hex << std::setw(16) << std::setfill('0')
+                  << game.getStateHash() << std::dec << "\n";
+
+        if (softwareVideoManager != nullptr)
+        {
+            if (!softwareVideoManager->saveImage(imagePath))
+            {
+                std::cout << "Error: Failed to write " << imagePath << std::endl;
+                return -1;
+            }
+        }
+
+#ifdef JUMP_PROFILING
+        if (Profiler::writeChromeTrace(Profiler::TRACE_PATH))
+        {
+            std::cout << "Wrote profile to " << Profiler::TRACE_PATH << std::endl;
+        }
+#endif
+    }
+    catch (std::exception& e)
+    {
+        std::cout << "Error: Unhandled exception caught in main():\n" << e.what() << std::endl;
+        return -1;
+    }
+    catch (...)
+    {
+        std::cout << "Error: Unknown exception caught in main()\n";
+        return -1;
+    }
+
+    return 0;
+}
@@ -1,9 +1,15 @@
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <string>
 
 #include <SDL2/SDL.h>
 
 #include "game/Game.hpp"
 #include "input/sdl2/Sdl2InputManager.hpp"
+#include "util/LatencyTracker.hpp"
+#include "util/Profiler.hpp"
+#include "video/sdl2/Sdl2SoftwareVideoManager.hpp"
 #include "video/sdl2/Sdl2VideoManager.hpp"
 
 #define WINDOW_RESOLUTION_X 640
@@ -12,6 +18,9 @@
 #define SCREEN_RESOLUTION_Y 240
 
 static SDL_Window* window = NULL;
+static bool softwareRendering = false;
+static bool inputThread = false;
+static std::string levelPath;
 
 /**
  * Clean up al resources used by libraries.
@@ -43,7 +52,7 @@ static int initialize()
         SDL_WINDOWPOS_CENTERED,
         WINDOW_RESOLUTION_X,
         WINDOW_RESOLUTION_Y,
-        SDL_WINDOW_OPENGL
+        softwareRendering ? 0 : SDL_WINDOW_OPENGL
     );
     if (window == NULL)
     {
@@ -51,6 +60,12 @@ static int initialize()
         return -1;
     }
 
+    // The software renderer presents through SDL instead of OpenGL
+    if (softwareRendering)
+    {
+        return 0;
+    }
+
     // Create the OpenGL context
     if (SDL_GL_CreateContext(window) == NULL)
     {
@@ -70,9 +85,31 @@ static int initialize()
 
 /**
  * Program entry point.
+ *
+ * Usage: Jump [--software] [--input-thread] [level]
+ *
+ * The --software option renders without OpenGL. The --input-thread option
+ * polls joysticks on a dedicated thread. If a level file is given, it is
+ * played instead of the built-in test level.
  */
 int main(int argc, char** argv)
 {
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--software") == 0)
+        {
+            softwareRendering = true;
+        }
+        else if (std::strcmp(argv[i], "--input-thread") == 0)
+        {
+            inputThread = true;
+        }
+        else
+        {
+            levelPath = argv[i];
+        }
+    }
+
     try
     {
         if (initialize() != 0)
@@ -84,7 +121,15 @@ int main(int argc, char** argv)
         else
         {
             // Setup managers
-            Sdl2VideoManager videoManager(window, SCREEN_RESOLUTION_X, SCREEN_RESOLUTION_Y);
+            std::unique_ptr<VideoManager> videoManager;
+            if (softwareRendering)
+            {
+                videoManager.reset(new Sdl2SoftwareVideoManager(window, SCREEN_RESOLUTION_X, SCREEN_RESOLUTION_Y));
+            }
+            else
+            {
+                videoManager.reset(new Sdl2VideoManager(window, SCREEN_RESOLUTION_X, SCREEN_RESOLUTION_Y));
+            }
 
             Sdl2InputManager inputManager;
 
@@ -104,10 +149,19 @@ int main(int argc, char** argv)
             inputManager.mapJoystickAxis(0, 0, 1, InputButton::RIGHT);
             inputManager.mapJoystickAxis(0, 1, -1, InputButton::UP);
             inputManager.mapJoystickButton(0, 7, InputButton::START);
+            if (inputThread)
+            {
+                inputManager.startInputThread();
+            }
 
             // Run the game
-            Game game(inputManager, videoManager);
+            Game game(inputManager, *videoManager, levelPath);
             game.run();
+
+#ifdef JUMP_PROFILING
+            Profiler::writeChromeTrace(Profiler::TRACE_PATH);
+            LatencyTracker::writeReport(std::cout);
+#endif
         }
     }
     catch (std::exception& e)
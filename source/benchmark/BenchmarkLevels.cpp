@@ -0,0 +1,141 @@
+#include <random>
+
+#include "../level/Block.hpp"
+#include "../level/Entity.hpp"
+#include "../level/Layer.hpp"
+#include "../level/Level.hpp"
+#include "../util/Util.hpp"
+
+#include "BenchmarkLevels.hpp"
+
+/**
+ * An entity that walks back and forth, turning around whenever it is stopped.
+ */
+class BenchmarkEntity : public Entity
+{
+public:
+    BenchmarkEntity(int directionSign) :
+        directionSign(directionSign)
+    {
+        setVelocityX(directionSign * WALKING_SPEED);
+        setAccelerationY(GRAVITY);
+    }
+
+protected:
+    void onUpdate()
+    {
+        if (getVelocityX() == 0)
+        {
+            directionSign = -directionSign;
+            setVelocityX(directionSign * WALKING_SPEED);
+        }
+        if (getVelocityY() > MAX_DOWNWARD_VELOCITY)
+        {
+            setVelocityY(MAX_DOWNWARD_VELOCITY);
+        }
+    }
+
+private:
+    static constexpr Fixed WALKING_SPEED = physicsValueFromHex(0x0180);
+    static constexpr Fixed GRAVITY = physicsValueFromHex(0x0050);
+    static constexpr Fixed MAX_DOWNWARD_VELOCITY = physicsValueFromHex(0x0450);
+
+    int directionSign; /**< -1 for walking left, 1 for walking right. */
+};
+
+constexpr Fixed BenchmarkEntity::WALKING_SPEED;
+constexpr Fixed BenchmarkEntity::GRAVITY;
+constexpr Fixed BenchmarkEntity::MAX_DOWNWARD_VELOCITY;
+
+Layer* createBenchmarkLayer(Level& level, int width)
+{
+    static constexpr int HEIGHT = 15;
+    static constexpr int SEGMENT_WIDTH = 8;
+
+    const Block* solid = Block::get(Block::CollisionType::SOLID);
+    const Block* platform = Block::get(Block::CollisionType::PLATFORM);
+    const Block* slopeLeft = Block::get(Block::CollisionType::SLOPE_LEFT);
+    const Block* slopeRight = Block::get(Block::CollisionType::SLOPE_RIGHT);
+    const Block* water = Block::get(Block::CollisionType::WATER, 4, 3);
+
+    Layer* layer = level.createLayer(width, HEIGHT);
+    for (int x = 0; x < width; x++)
+    {
+        layer->addBlock(x, HEIGHT - 1, solid);
+        layer->addBlock(x, 0, solid);
+    }
+    for (int y = 1; y < HEIGHT - 1; y++)
+    {
+        layer->addBlock(0, y, solid);
+        layer->addBlock(width - 1, y, solid);
+    }
+
+    // Fill the layer with one feature per segment. The engine's raw output
+    // is used directly, since distributions differ between libraries.
+    std::minstd_rand random(1);
+    for (int x = 2; x + SEGMENT_WIDTH < width - 1; x += SEGMENT_WIDTH)
+    {
+        int offset = random() % (SEGMENT_WIDTH - 4);
+        switch (random() % 6)
+        {
+        case 0: // Hill
+            layer->addBlock(x + offset, HEIGHT - 2, slopeRight);
+            layer->addBlock(x + offset + 1, HEIGHT - 2, slopeLeft);
+            break;
+        case 1: // Pillar
+            for (int y = HEIGHT - 2 - random() % 3; y < HEIGHT - 1; y++)
+            {
+                layer->addBlock(x + offset, y, solid);
+            }
+            break;
+        case 2: // Platforms
+            for (int i = 0; i < 3; i++)
+            {
+                layer->addBlock(x + offset + i, HEIGHT - 5, platform);
+            }
+            break;
+        case 3: // Pool
+            layer->addBlock(x + offset, HEIGHT - 4, water);
+            break;
+        case 4: // Ledge
+            layer->addBlock(x + offset, HEIGHT - 6, solid);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return layer;
+}
+
+Level* createBenchmarkLevel(int width, int movingLayerCount, int entityCount)
+{
+    Level* level = new Level();
+    level->addLayer(createBenchmarkLayer(*level, width));
+
+    // Platforms drifting left and right through the middle of the level
+    int spacing = width * Level::TILE_SIZE / (movingLayerCount + 1);
+    for (int i = 0; i < movingLayerCount; i++)
+    {
+        Layer* platform = level->createLayer(4, 1);
+        for (int x = 0; x < 4; x++)
+        {
+            platform->addBlock(x, 0, Block::get(Block::CollisionType::PLATFORM));
+        }
+        platform->setX((i + 1) * spacing);
+        platform->setY(7 * Level::TILE_SIZE + (i % 4) * Level::TILE_SIZE);
+        platform->setVelocityX((i % 2 == 0) ? physicsValueFromHex(0x0080) : -1 * physicsValueFromHex(0x0080));
+        level->addLayer(platform);
+    }
+
+    // Entities spread evenly along the level, dropped in from the top
+    int entitySpacing = (width - 2) * Level::TILE_SIZE / (entityCount + 1);
+    for (int i = 0; i < entityCount; i++)
+    {
+        Entity* entity = level->createEntity<BenchmarkEntity>((i % 2 == 0) ? 1 : -1);
+        entity->setX(Level::TILE_SIZE + (i + 1) * entitySpacing);
+        entity->setY(Level::TILE_SIZE);
+    }
+
+    return level;
+}
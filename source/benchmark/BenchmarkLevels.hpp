@@ -0,0 +1,27 @@
+#ifndef BENCHMARKLEVELS_HPP
+#define BENCHMARKLEVELS_HPP
+
+class Layer;
+class Level;
+
+/**
+ * Generate the terrain layer used by the benchmarks.
+ *
+ * The layer is 15 tiles high and walled in, with a mix of all block types
+ * laid out pseudo-randomly (but identically on every run).
+ *
+ * @param level the level to create the layer in. The layer is not added to it.
+ * @param width the width of the layer, in tiles.
+ */
+Layer* createBenchmarkLayer(Level& level, int width);
+
+/**
+ * Generate a level for the benchmarks.
+ *
+ * @param width the width of the terrain layer, in tiles.
+ * @param movingLayerCount the number of moving platform layers to add.
+ * @param entityCount the number of walking entities to add.
+ */
+Level* createBenchmarkLevel(int width, int movingLayerCount, int entityCount);
+
+#endif // BENCHMARKLEVELS_HPP
@@ -0,0 +1,378 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../level/Block.hpp"
+#include "../level/Layer.hpp"
+#include "../level/Level.hpp"
+#include "../level/LevelFile.hpp"
+#include "../video/null/NullVideoManager.hpp"
+#include "../video/software/SoftwareVideoManager.hpp"
+
+#include "BenchmarkLevels.hpp"
+
+/**
+ * Results of benchmarked queries, kept so the compiler can't optimize them out.
+ */
+static volatile long sink;
+
+static double minimumSeconds = 0.25;
+static const char* filter = nullptr;
+
+/**
+ * A rectangle to query, in pixels.
+ */
+struct Query
+{
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+/**
+ * Run a benchmark and print its results as a CSV row.
+ *
+ * The benchmark is run once to warm up, then repeated until it has run for
+ * at least minimumSeconds.
+ *
+ * @param name the name of the benchmark.
+ * @param parameter the value of the swept parameter (e.g. the entity count).
+ * @param operationsPerRun the number of operations performed by each call to run.
+ * @param run the function performing the operations.
+ */
+template <typename Function>
+static void benchmark(const char* name, long parameter, long operationsPerRun, Function run)
+{
+    if (filter != nullptr && std::strstr(name, filter) == nullptr)
+    {
+        return;
+    }
+
+    // Run once untimed, so that caches (e.g. layer geometry) are built
+    run();
+
+    typedef std::chrono::steady_clock Clock;
+    long runs = 0;
+    std::chrono::duration<double> elapsed(0);
+    auto start = Clock::now();
+    do
+    {
+        run();
+        runs++;
+        elapsed = Clock::now() - start;
+    } while (elapsed.count() < minimumSeconds);
+
+    double operations = static_cast<double>(runs) * operationsPerRun;
+    std::cout << name << ',' << parameter << ',' << runs * operationsPerRun << ','
+              << elapsed.count() * 1e9 / operations << std::endl;
+}
+
+/**
+ * Generate random query rectangles within a layer.
+ */
+static std::vector<Query> createQueries(const Layer& layer, int width, int height)
+{
+    static constexpr int QUERY_COUNT = 4096;
+
+    std::minstd_rand random(2);
+    std::vector<Query> queries(QUERY_COUNT);
+    for (auto& query : queries)
+    {
+        query.left = layer.getLeft() + random() % (layer.getRight() - layer.getLeft() + 2 - width);
+        query.top = layer.getTop() + random() % (layer.getBottom() - layer.getTop() + 2 - height);
+        query.right = query.left + width - 1;
+        query.bottom = query.top + height - 1;
+    }
+    return queries;
+}
+
+/**
+ * Read a whole file into memory.
+ */
+static std::string readFile(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/**
+ * Add a layer above a level with water blocks that other blocks were placed
+ * partly over, which level files must keep as they are.
+ */
+static void addOverlappingLayer(Level& level)
+{
+    static constexpr int WIDTH = 8;
+    static constexpr int HEIGHT = 3;
+
+    const Block* water = Block::get(Block::CollisionType::WATER, 4, 3);
+    Layer* layer = level.createLayer(WIDTH, HEIGHT);
+    layer->addBlock(0, 0, water);
+    layer->addBlock(0, 0, Block::get(Block::CollisionType::SOLID));
+    layer->addBlock(2, 1, Block::get(Block::CollisionType::SOLID, 3, 1));
+    layer->addBlock(-1, 2, water);
+    layer->addBlock(4, 0, water);
+    layer->addBlock(3, 0, Block::get(Block::CollisionType::SLOPE_RIGHT, 2, 2));
+    layer->setY(-HEIGHT * Level::TILE_SIZE);
+    level.addLayer(layer);
+}
+
+/**
+ * Check if two levels have water in the same tiles.
+ */
+static bool haveSameWater(const Level& a, const Level& b)
+{
+    if (a.getLeft() != b.getLeft() || a.getTop() != b.getTop() ||
+        a.getRight() != b.getRight() || a.getBottom() != b.getBottom())
+    {
+        return false;
+    }
+    for (int y = a.getTop() + Level::TILE_SIZE / 2; y < a.getBottom(); y += Level::TILE_SIZE)
+    {
+        for (int x = a.getLeft() + Level::TILE_SIZE / 2; x < a.getRight(); x += Level::TILE_SIZE)
+        {
+            if (a.isUnderwaterAt(x, y) != b.isUnderwaterAt(x, y))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void benchmarkBlocks()
+{
+    const Block::CollisionType types[] = {Block::CollisionType::SOLID, Block::CollisionType::SLOPE_RIGHT};
+    for (auto type : types)
+    {
+        Block block(type);
+        long parameter = static_cast<long>(type);
+        long pixels = block.getWidth() * block.getHeight();
+        auto forEachPixel = [&](bool (Block::*check)(int, int) const) {
+            long count = 0;
+            for (int y = 0; y < block.getHeight(); y++)
+            {
+                for (int x = 0; x < block.getWidth(); x++)
+                {
+                    count += (block.*check)(x, y);
+                }
+            }
+            sink = sink + count;
+        };
+        benchmark("Block::hasBottomCollision", parameter, pixels, [&]() { forEachPixel(&Block::hasBottomCollision); });
+        benchmark("Block::hasLeftCollision", parameter, pixels, [&]() { forEachPixel(&Block::hasLeftCollision); });
+        benchmark("Block::hasRightCollision", parameter, pixels, [&]() { forEachPixel(&Block::hasRightCollision); });
+        benchmark("Block::hasSlopeCollision", parameter, pixels, [&]() { forEachPixel(&Block::hasSlopeCollision); });
+        benchmark("Block::hasTopCollision", parameter, pixels, [&]() { forEachPixel(&Block::hasTopCollision); });
+    }
+}
+
+static void benchmarkLayers()
+{
+    const int widths[] = {256, 1024, 4096, 16384, 100000};
+    for (auto width : widths)
+    {
+        Level level;
+        Layer* layer = createBenchmarkLayer(level, width);
+        std::vector<Query> points = createQueries(*layer, 1, 1);
+        std::vector<Query> rows = createQueries(*layer, Level::TILE_SIZE, 1);
+        std::vector<Query> columns = createQueries(*layer, 1, 2 * Level::TILE_SIZE);
+
+        benchmark("Layer::getBlockAt", width, points.size(), [&]() {
+            long count = 0;
+            for (auto& point : points)
+            {
+                count += (layer->getBlockAt(point.left, point.top) != nullptr);
+            }
+            sink = sink + count;
+        });
+        benchmark("Layer::hasSlopeCollision", width, points.size(), [&]() {
+            long count = 0;
+            for (auto& point : points)
+            {
+                count += layer->hasSlopeCollision(point.left, point.top);
+            }
+            sink = sink + count;
+        });
+        benchmark("Layer::hasTopCollision", width, points.size(), [&]() {
+            long count = 0;
+            for (auto& point : points)
+            {
+                count += layer->hasTopCollision(point.left, point.top);
+            }
+            sink = sink + count;
+        });
+        benchmark("Layer::hasTopCollisionInRow", width, rows.size(), [&]() {
+            long count = 0;
+            for (auto& row : rows)
+            {
+                count += layer->hasTopCollisionInRow(row.left, row.right, row.top);
+            }
+            sink = sink + count;
+        });
+        benchmark("Layer::hasLeftCollisionInColumn", width, columns.size(), [&]() {
+            long count = 0;
+            for (auto& column : columns)
+            {
+                count += layer->hasLeftCollisionInColumn(column.left, column.top, column.bottom);
+            }
+            sink = sink + count;
+        });
+    }
+}
+
+static void benchmarkLevelUpdates()
+{
+    // Each operation is one frame
+    const int entityCounts[] = {1, 10, 100, 1000, 10000};
+    for (auto entityCount : entityCounts)
+    {
+        Level* level = createBenchmarkLevel(1024, 8, entityCount);
+        benchmark("Level::update/entities", entityCount, 1, [&]() { level->update(); });
+        delete level;
+    }
+
+    const int layerCounts[] = {1, 4, 16, 64, 256};
+    for (auto layerCount : layerCounts)
+    {
+        Level* level = createBenchmarkLevel(1024, layerCount - 1, 100);
+        benchmark("Level::update/layers", layerCount, 1, [&]() { level->update(); });
+        delete level;
+    }
+
+    const int widths[] = {256, 1024, 4096, 16384, 100000};
+    for (auto width : widths)
+    {
+        Level* level = createBenchmarkLevel(width, 8, 100);
+        benchmark("Level::update/width", width, 1, [&]() { level->update(); });
+        delete level;
+    }
+}
+
+/**
+ * Benchmark building levels, and check that level files read back into the
+ * same levels.
+ *
+ * @return false if a level file did not read back into the same level.
+ */
+static bool benchmarkLevelLoading()
+{
+    // Each operation is one level built from scratch, and then destroyed
+    static const char* PATH = "JumpBenchmark.level";
+    static const char* COPY_PATH = "JumpBenchmark.copy.level";
+    const int widths[] = {256, 1024, 4096, 16384, 100000};
+    bool passed = true;
+    for (auto width : widths)
+    {
+        benchmark("Level/generated", width, 1, [&]() { delete createBenchmarkLevel(width, 8, 0); });
+
+        // The level read from the file must have the same water, and writing
+        // it must give the same file
+        Level* level = createBenchmarkLevel(width, 8, 0);
+        addOverlappingLayer(*level);
+        LevelFile::write(PATH, *level, {{LevelFile::SPAWN_PLAYER, Level::TILE_SIZE, Level::TILE_SIZE}});
+        bool sameLevel;
+        {
+            LevelFile file(PATH);
+            Level* copy = file.createLevel();
+            sameLevel = haveSameWater(*level, *copy);
+            LevelFile::write(COPY_PATH, *copy, {file.getSpawns(), file.getSpawns() + file.getSpawnCount()});
+            delete copy;
+        }
+        delete level;
+        if (!sameLevel || readFile(PATH) != readFile(COPY_PATH))
+        {
+            std::cerr << "Error: level file of width " << width << " did not read back into the same level" << std::endl;
+            passed = false;
+        }
+
+        benchmark("LevelFile::createLevel", width, 1, [&]() {
+            LevelFile file(PATH);
+            delete file.createLevel();
+        });
+    }
+    std::remove(PATH);
+    std::remove(COPY_PATH);
+    return passed;
+}
+
+static void benchmarkLevelRendering()
+{
+    // Each operation is one frame, with the camera panning across the level
+    NullVideoManager video(320, 240);
+    const int widths[] = {256, 1024, 4096, 16384, 100000};
+    for (auto width : widths)
+    {
+        Level* level = createBenchmarkLevel(width, 8, 100);
+        int cameraX = 0;
+        int cameraRange = width * Level::TILE_SIZE - video.getScreenWidth();
+        benchmark("Level::render/width", width, 1, [&]() {
+            level->render(video, cameraX, cameraX + video.getScreenWidth(), 0, video.getScreenHeight());
+            cameraX = (cameraX + 7) % cameraRange;
+        });
+        delete level;
+    }
+
+    const int entityCounts[] = {1, 100, 10000};
+    for (auto entityCount : entityCounts)
+    {
+        Level* level = createBenchmarkLevel(1024, 8, entityCount);
+        benchmark("Level::render/entities", entityCount, 1, [&]() {
+            level->render(video, 0, video.getScreenWidth(), 0, video.getScreenHeight());
+        });
+        delete level;
+    }
+
+    // Rasterizing in software, including clearing the screen
+    SoftwareVideoManager softwareVideo(320, 240);
+    for (auto width : widths)
+    {
+        Level* level = createBenchmarkLevel(width, 8, 100);
+        int cameraX = 0;
+        int cameraRange = width * Level::TILE_SIZE - softwareVideo.getScreenWidth();
+        benchmark("Level::render/software", width, 1, [&]() {
+            softwareVideo.clearScreen();
+            level->render(softwareVideo, cameraX, cameraX + softwareVideo.getScreenWidth(), 0, softwareVideo.getScreenHeight());
+            cameraX = (cameraX + 7) % cameraRange;
+        });
+        delete level;
+    }
+}
+
+/**
+ * Program entry point for the simulation benchmarks.
+ *
+ * Usage: JumpBenchmark [filter] [minimum seconds per benchmark]
+ *
+ * Prints one CSV row per benchmark and parameter value, with the time taken
+ * by each operation in nanoseconds. Only benchmarks whose name contains the
+ * filter are run. Exits with an error if a level file does not read back
+ * into the same level.
+ */
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        filter = argv[1];
+    }
+    if (argc > 2)
+    {
+        minimumSeconds = std::atof(argv[2]);
+    }
+
+    std::cout << "benchmark,parameter,operations,nanoseconds_per_operation" << std::endl;
+    benchmarkBlocks();
+    benchmarkLayers();
+    benchmarkLevelUpdates();
+    bool passed = benchmarkLevelLoading();
+    benchmarkLevelRendering();
+
+    return passed ? 0 : -1;
+}
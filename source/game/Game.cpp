@@ -1,30 +1,96 @@
+#include <chrono>
+
 #include "../input/InputManager.hpp"
+#include "../util/Profiler.hpp"
 #include "../video/VideoManager.hpp"
 #include "states/StartupState.hpp"
 
 #include "Game.hpp"
 
-Game::Game(InputManager& inputManager, VideoManager& videoManager) :
+constexpr int Game::UPDATES_PER_SECOND;
+constexpr int Game::MAX_UPDATES_PER_FRAME;
+
+Game::Game(InputManager& inputManager, VideoManager& videoManager, const std::string& levelPath) :
     inputManager(inputManager),
-    videoManager(videoManager)
+    videoManager(videoManager),
+    interpolationEnabled(true)
 {
     // Run the StartupState initially
-    gameStateManager.pushState(new StartupState);
+    gameStateManager.pushState(new StartupState(levelPath));
+}
+
+uint64_t Game::getStateHash() const
+{
+    return gameStateManager.getStateHash();
+}
+
+void Game::render(Fixed interpolation)
+{
+    videoManager.clearScreen();
+    gameStateManager.render(videoManager, interpolation);
+    videoManager.updateScreen();
 }
 
 void Game::run()
 {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration updateInterval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<Clock::rep, std::ratio<1, UPDATES_PER_SECOND>>(1)
+    );
+
+    // Time that has passed but has not been simulated yet
+    Clock::duration lag(0);
+    Clock::time_point previousTime = Clock::now();
     while (!inputManager.shutdownReceived() && gameStateManager.isRunning())
     {
-        // Render
-        videoManager.clearScreen();
-        gameStateManager.render(videoManager);
-        videoManager.updateScreen();
+        PROFILE_ZONE("Game::frame");
 
-        // Handle input
-        inputManager.update();
+        Clock::time_point currentTime = Clock::now();
+        lag += currentTime - previousTime;
+        previousTime = currentTime;
+        if (lag > MAX_UPDATES_PER_FRAME * updateInterval)
+        {
+            lag = MAX_UPDATES_PER_FRAME * updateInterval;
+        }
 
-        // Update
-        gameStateManager.update();
+        // Update, with each update covering the oldest interval of the time
+        // that hasn't been simulated yet
+        while (lag >= updateInterval)
+        {
+            update(currentTime - lag + updateInterval);
+            lag -= updateInterval;
+        }
+
+        // Render somewhere between the last two updates, based on the leftover time
+        Fixed interpolation = 1;
+        if (interpolationEnabled)
+        {
+            interpolation = Fixed::fromRaw(static_cast<int32_t>(lag.count() * Fixed::ONE / updateInterval.count()));
+        }
+        render(interpolation);
     }
 }
+
+void Game::runUnthrottled()
+{
+    while (!inputManager.shutdownReceived() && gameStateManager.isRunning())
+    {
+        PROFILE_ZONE("Game::frame");
+
+        // Load states in a fixed number of frames, so that runs are repeatable
+        gameStateManager.waitForLoading();
+        render(1);
+        update(std::chrono::steady_clock::now());
+    }
+}
+
+void Game::setInterpolationEnabled(bool enabled)
+{
+    interpolationEnabled = enabled;
+}
+
+void Game::update(std::chrono::steady_clock::time_point time)
+{
+    inputManager.update(time);
+    gameStateManager.update();
+}
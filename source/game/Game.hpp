@@ -1,6 +1,10 @@
 #ifndef GAME_HPP
 #define GAME_HPP
 
+#include <chrono>
+#include <cstdint>
+#include <string>
+
 #include "GameStateManager.hpp"
 
 class InputManager;
@@ -12,20 +16,67 @@ class VideoManager;
 class Game
 {
 public:
+    /**
+     * The number of times the game is updated per second.
+     */
+    static constexpr int UPDATES_PER_SECOND = 60;
+
+    /**
+     * The most updates run to catch up before rendering a frame. Any time
+     * beyond that is dropped, slowing the game down instead of falling
+     * further behind.
+     */
+    static constexpr int MAX_UPDATES_PER_FRAME = 5;
+
     /**
      * Constructor.
+     *
+     * @param levelPath the level file to play, or an empty string for the
+     * built-in test level.
+     */
+    Game(InputManager& inputManager, VideoManager& videoManager, const std::string& levelPath = "");
+
+    /**
+     * Get a hash of the current game state's simulation, for checking that
+     * two runs simulated the same thing.
      */
-    Game(InputManager& inputManager, VideoManager& videoManager);
+    uint64_t getStateHash() const;
 
     /**
-     * Run the game.
+     * Run the game, updating it at a fixed rate and rendering as often as
+     * the video manager allows.
      */
     void run();
 
+    /**
+     * Run the game with one update per rendered frame, as fast as possible.
+     *
+     * Game states are waited for while they load, so every run simulates
+     * the same frames.
+     */
+    void runUnthrottled();
+
+    /**
+     * Set whether moving objects are rendered in between their positions
+     * from the last two updates (the default), or at their last positions.
+     */
+    void setInterpolationEnabled(bool enabled);
+
 private:
     GameStateManager gameStateManager;
     InputManager& inputManager;
     VideoManager& videoManager;
+    bool interpolationEnabled;
+
+    void render(Fixed interpolation);
+
+    /**
+     * Update the game by one step.
+     *
+     * @param time the time at the end of the step, which input after it is
+     * left for.
+     */
+    void update(std::chrono::steady_clock::time_point time);
 };
 
 #endif // GAME_HPP
@@ -8,8 +8,7 @@ GameState::GameState() :
 
 void GameState::changeState(GameState* state)
 {
-    popState();
-    pushState(state);
+    gameStateManager->changeState(state);
 }
 
 void GameState::popState()
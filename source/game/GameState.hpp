@@ -1,6 +1,10 @@
 #ifndef GAMESTATE_HPP
 #define GAMESTATE_HPP
 
+#include <cstdint>
+
+#include "../util/Fixed.hpp"
+
 class GameStateManager;
 class VideoManager;
 
@@ -20,14 +24,38 @@ public:
 
 protected:
     /**
-     * Change the current game state to a different state.
+     * Change the current game state to a different state, once it has loaded.
      */
     void changeState(GameState* state);
 
+    /**
+     * Get a hash of the state's simulation, which is the same in every run
+     * given the same input. States without a simulation return 0.
+     */
+    virtual uint64_t getStateHash() const { return 0; }
+
+    /**
+     * Event called on a background thread when the state is pushed, to
+     * prepare resources that are slow to create, such as the level. The
+     * previous state keeps running until it returns.
+     *
+     * Must not touch anything shared with the running state.
+     */
+    virtual void onLoad() {}
+
     /**
      * Event called whenever the state is requested to render to the screen.
+     *
+     * @param interpolation how far between the last two updates to render
+     * moving objects, from 0 (the previous update) to 1 (the last update).
+     */
+    virtual void onRender(VideoManager& video, Fixed interpolation) const =0;
+
+    /**
+     * Event called once the state has loaded and replaced or covered the
+     * previous state, before it is first updated.
      */
-    virtual void onRender(VideoManager& video) const =0;
+    virtual void onStart() {}
 
     /**
      * Event called once per frame to have the state update itself.
@@ -40,7 +68,8 @@ protected:
     void popState();
 
     /**
-     * Push a new state onto the top of the state stack and start executing.
+     * Push a new state onto the top of the state stack and start executing
+     * it once it has loaded.
      */
     void pushState(GameState* state);
 
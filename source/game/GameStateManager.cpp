@@ -1,18 +1,89 @@
+#include <chrono>
+
+#include "../util/Profiler.hpp"
+
 #include "GameState.hpp"
 #include "GameStateManager.hpp"
 
+GameStateManager::GameStateManager() :
+    loadingState(nullptr),
+    loadingReplacesState(false)
+{
+}
+
 GameStateManager::~GameStateManager()
 {
+    // The loading state can't be freed until its thread is done with it
+    if (loadingState != nullptr)
+    {
+        loadingResult.wait();
+        delete loadingState;
+    }
+
     // Free all game states
     for (auto state : stateStack)
     {
         delete state;
     }
+    for (auto state : deadStates)
+    {
+        delete state;
+    }
+}
+
+void GameStateManager::beginLoading(GameState* state, bool replace)
+{
+    if (loadingState != nullptr)
+    {
+        waitForLoading();
+        finishLoading();
+    }
+
+    state->gameStateManager = this;
+    loadingState = state;
+    loadingReplacesState = replace;
+    loadingResult = std::async(std::launch::async, &GameState::onLoad, state);
+}
+
+void GameStateManager::changeState(GameState* state)
+{
+    beginLoading(state, true);
+}
+
+void GameStateManager::finishLoading()
+{
+    GameState* state = loadingState;
+    loadingState = nullptr;
+    try
+    {
+        loadingResult.get();
+    }
+    catch (...)
+    {
+        delete state;
+        throw;
+    }
+
+    if (loadingReplacesState)
+    {
+        popState();
+    }
+    stateStack.push_back(state);
+    state->onStart();
+}
+
+uint64_t GameStateManager::getStateHash() const
+{
+    if (stateStack.empty())
+    {
+        return 0;
+    }
+    return stateStack.back()->getStateHash();
 }
 
 bool GameStateManager::isRunning() const
 {
-    return !stateStack.empty();
+    return !stateStack.empty() || loadingState != nullptr;
 }
 
 void GameStateManager::popState()
@@ -27,21 +98,28 @@ void GameStateManager::popState()
 
 void GameStateManager::pushState(GameState* state)
 {
-    state->gameStateManager = this;
-    stateStack.push_back(state);
+    beginLoading(state, false);
 }
 
-void GameStateManager::render(VideoManager& videoManager) const
+void GameStateManager::render(VideoManager& videoManager, Fixed interpolation) const
 {
+    PROFILE_ZONE("GameStateManager::render");
     if (!stateStack.empty())
     {
         GameState* state = stateStack.back();
-        state->onRender(videoManager);
+        state->onRender(videoManager, interpolation);
     }
 }
 
 void GameStateManager::update()
 {
+    PROFILE_ZONE("GameStateManager::update");
+    if (loadingState != nullptr &&
+        loadingResult.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        finishLoading();
+    }
+
     if (!stateStack.empty())
     {
         GameState* state = stateStack.front();
@@ -55,3 +133,12 @@ void GameStateManager::update()
     }
     deadStates.clear();
 }
+
+void GameStateManager::waitForLoading()
+{
+    PROFILE_ZONE("GameStateManager::waitForLoading");
+    if (loadingState != nullptr)
+    {
+        loadingResult.wait();
+    }
+}
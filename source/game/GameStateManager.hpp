@@ -1,22 +1,46 @@
 #ifndef GAMESTATEMANAGER_HPP
 #define GAMESTATEMANAGER_HPP
 
+#include <cstdint>
+#include <future>
 #include <list>
 #include <set>
 
+#include "../util/Fixed.hpp"
+
 class GameState;
 class VideoManager;
 
 /**
  * Manages the execution of different game states.
+ *
+ * New states are loaded on a background thread (see GameState::onLoad())
+ * while the current state keeps running, and only start running once
+ * loading has finished. One state is loaded at a time.
  */
 class GameStateManager
 {
 public:
+    /**
+     * Constructor.
+     */
+    GameStateManager();
+
     ~GameStateManager();
 
     /**
-     * Check if a game state is currently running.
+     * Load a game state, then replace the current state with it.
+     */
+    void changeState(GameState* state);
+
+    /**
+     * Get a hash of the current state's simulation (see
+     * GameState::getStateHash()), or 0 if no state is running.
+     */
+    uint64_t getStateHash() const;
+
+    /**
+     * Check if a game state is currently running or being loaded.
      */
     bool isRunning() const;
 
@@ -26,23 +50,49 @@ public:
     void popState();
 
     /**
-     * Push a game state onto the stack and begin executing it.
+     * Load a game state, then push it onto the stack and begin executing it.
      */
     void pushState(GameState* state);
 
     /**
      * Render the current state.
+     *
+     * @param interpolation how far between the last two updates to render
+     * moving objects, from 0 (the previous update) to 1 (the last update).
      */
-    void render(VideoManager& videoManager) const;
+    void render(VideoManager& videoManager, Fixed interpolation) const;
 
     /**
-     * Update the current state by one frame.
+     * Update the current state by one frame, first switching to the state
+     * being loaded if it has finished.
+     *
+     * @throws any exception thrown while loading the state.
      */
     void update();
 
+    /**
+     * Block until the state being loaded, if any, has finished loading, so
+     * that it starts running at the next update. Used where the game must
+     * run the same way every time, regardless of how long loading takes.
+     */
+    void waitForLoading();
+
 private:
     std::set<GameState*> deadStates;
     std::list<GameState*> stateStack;
+    GameState* loadingState; /**< State being loaded, or nullptr. */
+    bool loadingReplacesState; /**< Whether the loading state replaces the current state, or is pushed over it. */
+    std::future<void> loadingResult; /**< Completes when the loading state's onLoad() returns. */
+
+    /**
+     * Start loading a state on a background thread.
+     */
+    void beginLoading(GameState* state, bool replace);
+
+    /**
+     * Start running the loaded state.
+     */
+    void finishLoading();
 };
 
 #endif // GAMESTATEMANAGER_HPP
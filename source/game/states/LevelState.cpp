@@ -1,21 +1,18 @@
 #include "../../input/InputManager.hpp"
 #include "../../level/Entity.hpp"
 #include "../../level/Level.hpp"
+#include "../../level/LevelFile.hpp"
 #include "../../level/entities/Player.hpp"
 #include "../../test/TestLevels.hpp"
 #include "../../video/VideoManager.hpp"
 
 #include "LevelState.hpp"
 
-LevelState::LevelState()
+LevelState::LevelState(const std::string& levelPath) :
+    levelPath(levelPath),
+    level(nullptr),
+    player(nullptr)
 {
-    level = createTestLevel();
-
-    player = new Player();
-    InputManager::getInstance().addListener(player);
-    player->setX(Level::TILE_SIZE);
-    player->setY(Level::TILE_SIZE);
-    level->addEntity(player);
 }
 
 LevelState::~LevelState()
@@ -24,12 +21,58 @@ LevelState::~LevelState()
     delete level;
 }
 
-void LevelState::onRender(VideoManager& video) const
+uint64_t LevelState::getStateHash() const
 {
-    level->render(video, 0, video.getScreenWidth(), 0, video.getScreenHeight());
+    return level->getStateHash();
+}
+
+void LevelState::onLoad()
+{
+    int playerX = Level::TILE_SIZE;
+    int playerY = Level::TILE_SIZE;
+    if (levelPath.empty())
+    {
+        level = createTestLevel();
+    }
+    else
+    {
+        LevelFile file(levelPath.c_str());
+        level = file.createLevel();
+        for (int i = 0; i < file.getSpawnCount(); i++)
+        {
+            const LevelFile::Spawn& spawn = file.getSpawns()[i];
+            if (spawn.type == LevelFile::SPAWN_PLAYER)
+            {
+                playerX = spawn.x;
+                playerY = spawn.y;
+            }
+        }
+    }
+
+    player = level->createEntity<Player>();
+    player->setX(playerX);
+    player->setY(playerY);
+    camera.setTarget(player);
+    camera.update(*level);
+}
+
+void LevelState::onRender(VideoManager& video, Fixed interpolation) const
+{
+    int width = video.getScreenWidth();
+    int height = video.getScreenHeight();
+    int left = camera.getLeft(width, interpolation);
+    int top = camera.getTop(height, interpolation);
+    level->render(video, left, left + width, top, top + height, interpolation);
+}
+
+void LevelState::onStart()
+{
+    // Input is delivered on the main thread, so only listen once loaded
+    InputManager::getInstance().addListener(player);
 }
 
 void LevelState::onUpdate()
 {
     level->update();
+    camera.update(*level);
 }
@@ -1,6 +1,10 @@
 #ifndef LEVELSTATE_HPP
 #define LEVELSTATE_HPP
 
+#include <string>
+
+#include "../../level/Camera.hpp"
+
 #include "../GameState.hpp"
 
 class Level;
@@ -14,15 +18,23 @@ class LevelState : public GameState
 public:
     /**
      * Constructor.
+     *
+     * @param levelPath the level file to play, or an empty string for the
+     * built-in test level.
      */
-    LevelState();
+    explicit LevelState(const std::string& levelPath = "");
     ~LevelState();
 
 private:
+    std::string levelPath;
     Level* level;
     Player* player;
+    Camera camera;
 
-    void onRender(VideoManager& video) const;
+    uint64_t getStateHash() const;
+    void onLoad();
+    void onRender(VideoManager& video, Fixed interpolation) const;
+    void onStart();
     void onUpdate();
 };
 
@@ -1,11 +1,21 @@
 #include "LevelState.hpp"
 #include "StartupState.hpp"
 
-void StartupState::onRender(VideoManager& video) const
+StartupState::StartupState(const std::string& levelPath) :
+    levelPath(levelPath)
 {
 }
 
+void StartupState::onRender(VideoManager& video, Fixed interpolation) const
+{
+}
+
+void StartupState::onStart()
+{
+    // Keep running until the level has loaded
+    changeState(new LevelState(levelPath));
+}
+
 void StartupState::onUpdate()
 {
-    changeState(new LevelState);
 }
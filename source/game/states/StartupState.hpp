@@ -1,6 +1,8 @@
 #ifndef STARTUPSTATE_HPP
 #define STARTUPSTATE_HPP
 
+#include <string>
+
 #include "../GameState.hpp"
 
 /**
@@ -8,8 +10,20 @@
  */
 class StartupState : public GameState
 {
+public:
+    /**
+     * Constructor.
+     *
+     * @param levelPath the level file to play, or an empty string for the
+     * built-in test level.
+     */
+    explicit StartupState(const std::string& levelPath = "");
+
 private:
-    void onRender(VideoManager& video) const;
+    std::string levelPath;
+
+    void onRender(VideoManager& video, Fixed interpolation) const;
+    void onStart();
     void onUpdate();
 };
 
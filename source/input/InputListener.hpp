@@ -1,6 +1,8 @@
 #ifndef INPUTLISTENER_HPP
 #define INPUTLISTENER_HPP
 
+#include <chrono>
+
 #include "InputButton.hpp"
 
 /**
@@ -11,8 +13,10 @@ class InputListener
 public:
     /**
      * Event handler for button presses.
+     *
+     * @param time when the press happened, as closely as the input manager knows.
      */
-    virtual void onButtonPress(InputButton buttonId) {}
+    virtual void onButtonPress(InputButton buttonId, std::chrono::steady_clock::time_point time) {}
 };
 
 #endif // INPUTLISTENER_HPP
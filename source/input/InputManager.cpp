@@ -13,11 +13,11 @@ InputManager& InputManager::getInstance()
     return *instance;
 }
 
-void InputManager::notifyButtonPress(InputButton buttonId)
+void InputManager::notifyButtonPress(InputButton buttonId, std::chrono::steady_clock::time_point time)
 {
     for (auto listener : listeners)
     {
-        listener->onButtonPress(buttonId);
+        listener->onButtonPress(buttonId, time);
     }
 }
 
@@ -1,6 +1,7 @@
 #ifndef INPUTMANAGER_HPP
 #define INPUTMANAGER_HPP
 
+#include <chrono>
 #include <list>
 
 #include "InputButton.hpp"
@@ -43,15 +44,20 @@ public:
     virtual bool shutdownReceived() const =0;
 
     /**
-     * Update the input system's state.
+     * Update the input system's state for a step of the game.
+     *
+     * @param time the time at the end of the step. Input managers that know
+     * when input happened leave later input for the next update.
      */
-    virtual void update()=0;
+    virtual void update(std::chrono::steady_clock::time_point time)=0;
 
 protected:
     /**
      * Notify listeners that a button was pressed.
+     *
+     * @param time when the press happened.
      */
-    void notifyButtonPress(InputButton buttonId);
+    void notifyButtonPress(InputButton buttonId, std::chrono::steady_clock::time_point time);
 
     /**
      * Set the singleton instance of the Input Manager.
@@ -0,0 +1,69 @@
+#include "NullInputManager.hpp"
+
+NullInputManager::NullInputManager(long frameCount, unsigned scriptSeed) :
+    frame(0),
+    frameCount(frameCount),
+    scripted(scriptSeed != 0),
+    script(scriptSeed)
+{
+    for (auto& state : buttonStates)
+    {
+        state = false;
+    }
+
+    setInstance(this);
+}
+
+long NullInputManager::getFrame() const
+{
+    return frame;
+}
+
+bool NullInputManager::isButtonPressed(InputButton buttonId) const
+{
+    return buttonStates[(int)buttonId];
+}
+
+void NullInputManager::setButtonPressed(InputButton buttonId)
+{
+    if (!buttonStates[(int)buttonId])
+    {
+        notifyButtonPress(buttonId, std::chrono::steady_clock::now());
+    }
+    buttonStates[(int)buttonId] = true;
+}
+
+void NullInputManager::setButtonReleased(InputButton buttonId)
+{
+    buttonStates[(int)buttonId] = false;
+}
+
+bool NullInputManager::shutdownReceived() const
+{
+    return frame >= frameCount;
+}
+
+void NullInputManager::update(std::chrono::steady_clock::time_point time)
+{
+    frame++;
+    if (!scripted || frame % SCRIPT_INTERVAL != 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < NUM_INPUT_BUTTONS; i++)
+    {
+        // Hold left and right more often than the other buttons, so that the
+        // player covers ground instead of jumping in place
+        InputButton button = static_cast<InputButton>(i);
+        unsigned chance = (button == InputButton::LEFT || button == InputButton::RIGHT) ? 45 : 30;
+        if (script() % 100 < chance)
+        {
+            setButtonPressed(button);
+        }
+        else
+        {
+            setButtonReleased(button);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef NULLINPUTMANAGER_HPP
+#define NULLINPUTMANAGER_HPP
+
+#include <random>
+
+#include "../InputManager.hpp"
+
+/**
+ * Input manager without an input device, for running without a display.
+ *
+ * Buttons only change when set by the program, or by a script of
+ * pseudo-random presses that is the same in every run with the same seed.
+ * A shutdown is requested after a fixed number of frames.
+ */
+class NullInputManager : public InputManager
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param frameCount the number of updates before a shutdown is requested.
+     * @param scriptSeed if non-zero, buttons are pressed and released by a
+     * script generated from this seed.
+     */
+    explicit NullInputManager(long frameCount, unsigned scriptSeed = 0);
+
+    /**
+     * Get the number of times the input system has been updated.
+     */
+    long getFrame() const;
+
+    bool isButtonPressed(InputButton buttonId) const;
+
+    /**
+     * Press a button, notifying listeners if it was released.
+     */
+    void setButtonPressed(InputButton buttonId);
+
+    /**
+     * Release a button.
+     */
+    void setButtonReleased(InputButton buttonId);
+
+    bool shutdownReceived() const;
+    void update(std::chrono::steady_clock::time_point time);
+
+private:
+    /**
+     * The number of updates between scripted changes to the buttons.
+     */
+    static constexpr int SCRIPT_INTERVAL = 7;
+
+    bool buttonStates[NUM_INPUT_BUTTONS];
+    long frame;
+    long frameCount;
+    bool scripted;
+    std::minstd_rand script; /**< Generates the scripted presses, with the same sequence on every platform. */
+};
+
+#endif // NULLINPUTMANAGER_HPP
@@ -2,15 +2,25 @@
 
 #include <SDL2/SDL.h>
 
+#include "../../util/LatencyTracker.hpp"
+#include "../../util/Profiler.hpp"
+
 #include "Sdl2InputManager.hpp"
 
+constexpr std::chrono::milliseconds Sdl2InputManager::POLL_INTERVAL;
+
 Sdl2InputManager::Sdl2InputManager() :
-    shutdownReceivedFlag(false)
+    shutdownReceivedFlag(false),
+    inputThreadRunning(false)
 {
     for (auto& state : buttonStates)
     {
         state = false;
     }
+    for (auto& state : joystickButtonStates)
+    {
+        state = false;
+    }
 
     // Open all joysticks for use
     for (int i = 0; i < SDL_NumJoysticks(); i++)
@@ -32,6 +42,12 @@ Sdl2InputManager::Sdl2InputManager() :
 
 Sdl2InputManager::~Sdl2InputManager()
 {
+    if (inputThread.joinable())
+    {
+        inputThreadRunning = false;
+        inputThread.join();
+    }
+
     for (auto joystick : joysticks)
     {
         SDL_JoystickClose(joystick);
@@ -52,6 +68,39 @@ bool Sdl2InputManager::isButtonPressed(InputButton buttonId) const
     return buttonStates[(int)buttonId];
 }
 
+bool Sdl2InputManager::isMappingPressed(const ButtonMapping& mapping, const Uint8* keystates)
+{
+    switch (mapping.type)
+    {
+    case ButtonMappingType::KEY:
+        return keystates[mapping.key] != 0;
+    case ButtonMappingType::JOYSTICK_AXIS:
+        {
+            SDL_Joystick* joystick = getJoystick(mapping.joystick);
+            if (!joystick)
+            {
+                return false;
+            }
+            Sint16 axisState = SDL_JoystickGetAxis(joystick, mapping.joystickAxis);
+            if (mapping.joystickAxisSign < 0)
+            {
+                return axisState < -16384;
+            }
+            return axisState > 16384;
+        }
+    case ButtonMappingType::JOYSTICK_BUTTON:
+        {
+            SDL_Joystick* joystick = getJoystick(mapping.joystick);
+            if (!joystick)
+            {
+                return false;
+            }
+            return SDL_JoystickGetButton(joystick, mapping.joystickButton) != 0;
+        }
+    }
+    return false;
+}
+
 void Sdl2InputManager::mapKey(SDL_Scancode key, InputButton buttonId)
 {
     ButtonMapping mapping;
@@ -82,11 +131,52 @@ void Sdl2InputManager::mapJoystickButton(int joystick, int joystickButton, Input
     buttonMappings.push_back(mapping);
 }
 
-void Sdl2InputManager::setButtonPressed(InputButton buttonId)
+void Sdl2InputManager::runInputThread()
+{
+    // The states last sent to the main thread
+    bool sentStates[NUM_INPUT_BUTTONS];
+    for (auto& state : sentStates)
+    {
+        state = false;
+    }
+
+    while (inputThreadRunning)
+    {
+        SDL_JoystickUpdate();
+        std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now();
+
+        bool buttonStatus[NUM_INPUT_BUTTONS];
+        for (auto& b : buttonStatus)
+        {
+            b = false;
+        }
+        for (auto& mapping : buttonMappings)
+        {
+            if (mapping.type != ButtonMappingType::KEY)
+            {
+                buttonStatus[(int)mapping.buttonId] |= isMappingPressed(mapping, nullptr);
+            }
+        }
+
+        // Send any changes. If the queue is full, the change is sent again on
+        // the next poll instead, so the final state is never lost.
+        for (int i = 0; i < NUM_INPUT_BUTTONS; i++)
+        {
+            if (buttonStatus[i] != sentStates[i] && buttonEdges.push({(InputButton)i, buttonStatus[i], time}))
+            {
+                sentStates[i] = buttonStatus[i];
+            }
+        }
+
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+}
+
+void Sdl2InputManager::setButtonPressed(InputButton buttonId, std::chrono::steady_clock::time_point time)
 {
     if (!buttonStates[(int)buttonId])
     {
-        notifyButtonPress(buttonId);
+        notifyButtonPress(buttonId, time);
     }
     buttonStates[(int)buttonId] = true;
 }
@@ -101,8 +191,20 @@ bool Sdl2InputManager::shutdownReceived() const
     return shutdownReceivedFlag;
 }
 
-void Sdl2InputManager::update()
+void Sdl2InputManager::startInputThread()
 {
+    // Stop SDL_PollEvent() from updating the joysticks, since the input
+    // thread does it from now on
+    SDL_JoystickEventState(SDL_IGNORE);
+
+    inputThreadRunning = true;
+    inputThread = std::thread(&Sdl2InputManager::runInputThread, this);
+}
+
+void Sdl2InputManager::update(std::chrono::steady_clock::time_point time)
+{
+    PROFILE_ZONE("Sdl2InputManager::update");
+
     // Poll SDL events
     SDL_Event event;
     while (SDL_PollEvent(&event))
@@ -115,6 +217,15 @@ void Sdl2InputManager::update()
             case SDL_SCANCODE_ESCAPE:
                 shutdownReceivedFlag = true;
                 break;
+#ifdef JUMP_PROFILING
+            case SDL_SCANCODE_F12:
+                if (Profiler::writeChromeTrace(Profiler::TRACE_PATH))
+                {
+                    std::cout << "Wrote profile to " << Profiler::TRACE_PATH << std::endl;
+                }
+                LatencyTracker::writeReport(std::cout);
+                break;
+#endif
             default:
                 break;
             }
@@ -129,7 +240,9 @@ void Sdl2InputManager::update()
         }
     }
 
+    // Key presses are only seen when events are pumped, so they are timed from here
     const Uint8* keystates = SDL_GetKeyboardState(NULL);
+    std::chrono::steady_clock::time_point pollTime = std::chrono::steady_clock::now();
 
     bool buttonStatus[NUM_INPUT_BUTTONS];
     for (auto& b : buttonStatus)
@@ -138,48 +251,37 @@ void Sdl2InputManager::update()
     }
 
     // Poll input mappings
-    for (auto mapping : buttonMappings)
+    bool threaded = inputThread.joinable();
+    for (auto& mapping : buttonMappings)
     {
-        bool state = false;
-        switch(mapping.type)
+        if (!threaded || mapping.type == ButtonMappingType::KEY)
         {
-        case ButtonMappingType::KEY:
-            if (keystates[mapping.key])
-            {
-                state = true;
-            }
-            break;
-        case ButtonMappingType::JOYSTICK_AXIS:
+            buttonStatus[(int)mapping.buttonId] |= isMappingPressed(mapping, keystates);
+        }
+    }
+
+    // Apply joystick changes from the input thread up to the end of the step,
+    // one at a time, so that every press within the step is notified.
+    if (threaded)
+    {
+        const ButtonEdge* edge;
+        while ((edge = buttonEdges.front()) != nullptr && edge->time <= time)
+        {
+            joystickButtonStates[(int)edge->buttonId] = edge->pressed;
+            if (edge->pressed)
             {
-                SDL_Joystick* joystick = getJoystick(mapping.joystick);
-                if (!joystick)
-                {
-                    break;
-                }
-                Sint16 axisState = SDL_JoystickGetAxis(joystick, mapping.joystickAxis);
-                if (mapping.joystickAxisSign < 0)
-                {
-                    state = (axisState < -16384);
-                }
-                else
-                {
-                    state = (axisState > 16384);
-                }
+                setButtonPressed(edge->buttonId, edge->time);
             }
-            break;
-        case ButtonMappingType::JOYSTICK_BUTTON:
+            else if (!buttonStatus[(int)edge->buttonId])
             {
-                SDL_Joystick* joystick = getJoystick(mapping.joystick);
-                if (!joystick)
-                {
-                    break;
-                }
-                state = (SDL_JoystickGetButton(joystick, mapping.joystickButton) != 0);
+                setButtonReleased(edge->buttonId);
             }
-            break;
+            buttonEdges.pop();
+        }
+        for (int i = 0; i < NUM_INPUT_BUTTONS; i++)
+        {
+            buttonStatus[i] |= joystickButtonStates[i];
         }
-
-        buttonStatus[(int)mapping.buttonId] |= state;
     }
 
     // Update input button states
@@ -187,7 +289,7 @@ void Sdl2InputManager::update()
     {
         if (buttonStatus[i])
         {
-            setButtonPressed((InputButton)i);
+            setButtonPressed((InputButton)i, pollTime);
         }
         else
         {
@@ -1,16 +1,30 @@
 #ifndef SDL2INPUTMANAGER_HPP
 #define SDL2INPUTMANAGER_HPP
 
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <vector>
 
+#include "../../util/SpscQueue.hpp"
+
 #include "../InputManager.hpp"
 
 /**
  * Input manager using SDL2.
+ *
+ * By default, all input is read once per update. Joysticks can instead be
+ * polled at a high rate on a dedicated thread (see startInputThread()), so
+ * that presses are seen by the update that covers the time they happened.
  */
 class Sdl2InputManager : public InputManager
 {
 public:
+    /**
+     * How often the input thread polls joysticks.
+     */
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{1};
+
     Sdl2InputManager();
     ~Sdl2InputManager();
 
@@ -32,7 +46,17 @@ public:
     void mapKey(SDL_Scancode key, InputButton buttonId);
 
     bool shutdownReceived() const;
-    void update();
+
+    /**
+     * Start polling joysticks on a dedicated thread.
+     *
+     * Must be called after all mappings have been added. Keyboard input is
+     * still read in update(), since SDL only delivers it to the thread that
+     * handles window events.
+     */
+    void startInputThread();
+
+    void update(std::chrono::steady_clock::time_point time);
 
 private:
     enum class ButtonMappingType
@@ -57,13 +81,38 @@ private:
         };
     };
 
+    /**
+     * A change in the joystick state of a button, seen by the input thread.
+     */
+    struct ButtonEdge
+    {
+        InputButton buttonId;
+        bool pressed;
+        std::chrono::steady_clock::time_point time;
+    };
+
     bool buttonStates[NUM_INPUT_BUTTONS];
     bool shutdownReceivedFlag;
     std::vector<SDL_Joystick*> joysticks;
     std::vector<ButtonMapping> buttonMappings;
+    bool joystickButtonStates[NUM_INPUT_BUTTONS]; /**< Joystick state of each button, from the input thread. */
+    std::atomic<bool> inputThreadRunning;
+    std::thread inputThread;
+    SpscQueue<ButtonEdge, 256> buttonEdges; /**< Sent from the input thread to update(), oldest first. */
 
     SDL_Joystick* getJoystick(int index);
-    void setButtonPressed(InputButton buttonId);
+
+    /**
+     * Check if a mapping's key or joystick control is pressed.
+     */
+    bool isMappingPressed(const ButtonMapping& mapping, const Uint8* keystates);
+
+    /**
+     * Poll the joysticks until the input thread is stopped. Run on the input thread.
+     */
+    void runInputThread();
+
+    void setButtonPressed(InputButton buttonId, std::chrono::steady_clock::time_point time);
     void setButtonReleased(InputButton buttonId);
 };
 
@@ -1,113 +1,162 @@
 #include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
 
 #include "Block.hpp"
 #include "Level.hpp"
 
-Block::Block(Block::CollisionType collisionType) :
-    collisionType(collisionType),
-    width(1),
-    height(1)
+/**
+ * Edges of a block that cause collisions.
+ */
+enum CollisionEdge : unsigned
 {
-}
+    EDGE_TOP = 1 << 0,
+    EDGE_BOTTOM = 1 << 1,
+    EDGE_LEFT = 1 << 2,
+    EDGE_RIGHT = 1 << 3
+};
 
-int Block::getBottom() const
-{
-    return getY() + getHeight() - 1;
-}
+/**
+ * Colliding edges for each Block::CollisionType, in declaration order.
+ */
+static constexpr unsigned COLLISION_EDGES[] = {
+    0,                                              // NONE
+    EDGE_TOP,                                       // PLATFORM
+    0,                                              // SLOPE_LEFT
+    0,                                              // SLOPE_RIGHT
+    EDGE_TOP | EDGE_BOTTOM | EDGE_LEFT | EDGE_RIGHT, // SOLID
+    0                                               // WATER
+};
 
-int Block::getHeight() const
-{
-    return height * Level::TILE_SIZE;
-}
+static_assert(Level::TILE_SIZE == 16, "Slope masks store one tile row in 16 bits");
 
-int Block::getLeft() const
+/**
+ * Check if a block of a particular collision type collides on an edge.
+ */
+static inline bool hasCollisionEdge(Block::CollisionType collisionType, CollisionEdge edge)
 {
-    return getX();
+    return (COLLISION_EDGES[static_cast<int>(collisionType)] & edge) != 0;
 }
 
-int Block::getRight() const
+Block::Block(Block::CollisionType collisionType, int width, int height) :
+    collisionType(collisionType),
+    width(width),
+    height(height)
 {
-    return getX() + getWidth() - 1;
+    updateSlopeMasks();
 }
 
-int Block::getTop() const
+const Block* Block::get(CollisionType collisionType, int width, int height)
 {
-    return getY();
+    static std::mutex definitionsMutex;
+    static std::map<std::tuple<CollisionType, int, int>, std::unique_ptr<Block>> definitions;
+
+    std::lock_guard<std::mutex> lock(definitionsMutex);
+    std::unique_ptr<Block>& definition = definitions[std::make_tuple(collisionType, width, height)];
+    if (!definition)
+    {
+        definition.reset(new Block(collisionType, width, height));
+    }
+    return definition.get();
 }
 
-int Block::getWidth() const
+int Block::getHeight() const
 {
-    return width * Level::TILE_SIZE;
+    return height * Level::TILE_SIZE;
 }
 
-int Block::getX() const
+uint8_t Block::getTileFlags(int x, int y) const
 {
-    return positionX * Level::TILE_SIZE;
+    uint8_t flags = 0;
+    if (y == 0 && hasCollisionEdge(collisionType, EDGE_TOP))
+    {
+        flags |= TILE_TOP_EDGE;
+    }
+    if (y == height - 1 && hasCollisionEdge(collisionType, EDGE_BOTTOM))
+    {
+        flags |= TILE_BOTTOM_EDGE;
+    }
+    if (x == 0 && hasCollisionEdge(collisionType, EDGE_LEFT))
+    {
+        flags |= TILE_LEFT_EDGE;
+    }
+    if (x == width - 1 && hasCollisionEdge(collisionType, EDGE_RIGHT))
+    {
+        flags |= TILE_RIGHT_EDGE;
+    }
+    if (!slopeMasks.empty())
+    {
+        flags |= TILE_SLOPE;
+    }
+    if (collisionType == CollisionType::WATER)
+    {
+        flags |= TILE_WATER;
+    }
+    return flags;
 }
 
-int Block::getY() const
+int Block::getWidth() const
 {
-    return positionY * Level::TILE_SIZE;
+    return width * Level::TILE_SIZE;
 }
 
 bool Block::hasBottomCollision(int x, int y) const
 {
-    return (collisionType == CollisionType::SOLID && y == getHeight() - 1);
+    return (hasCollisionEdge(collisionType, EDGE_BOTTOM) && y == getHeight() - 1);
 }
 
 bool Block::hasLeftCollision(int x, int y) const
 {
-    return (collisionType == CollisionType::SOLID && x == 0);
+    return (hasCollisionEdge(collisionType, EDGE_LEFT) && x == 0);
 }
 
 bool Block::hasRightCollision(int x, int y) const
 {
-    return (collisionType == CollisionType::SOLID && x == getWidth() - 1);
+    return (hasCollisionEdge(collisionType, EDGE_RIGHT) && x == getWidth() - 1);
 }
 
 bool Block::hasSlopeCollision(int x, int y) const
 {
-    switch(collisionType)
+    if (slopeMasks.empty() || x < 0 || x >= getWidth() || y < 0 || y >= getHeight())
     {
-    case CollisionType::SLOPE_LEFT:
-        {
-            int h = static_cast<int>(std::floor(
-                (static_cast<float>(height) / static_cast<float>(width)) *
-                (x + 0.5f)
-            ));
-            return (y == h);
-        }
-    case CollisionType::SLOPE_RIGHT:
-        {
-            int h = static_cast<int>(std::floor(
-                -1.0f * (static_cast<float>(height) / static_cast<float>(width)) *
-                (x + 0.5f) + (height * Level::TILE_SIZE)
-            ));
-            return (y == h);
-        }
-    default:
         return false;
     }
+    uint16_t mask = slopeMasks[y * width + x / Level::TILE_SIZE];
+    return ((mask >> (x % Level::TILE_SIZE)) & 1) != 0;
 }
 
 bool Block::hasTopCollision(int x, int y) const
 {
-    switch (collisionType)
-    {
-    case CollisionType::PLATFORM:
-    case CollisionType::SOLID:
-        return (y == 0);
-    default:
-        return false;
-    }
+    return (hasCollisionEdge(collisionType, EDGE_TOP) && y == 0);
 }
 
-void Block::setHeight(int height)
+void Block::updateSlopeMasks()
 {
-    this->height = height;
-}
+    slopeMasks.clear();
+    if (collisionType != CollisionType::SLOPE_LEFT && collisionType != CollisionType::SLOPE_RIGHT)
+    {
+        return;
+    }
+    slopeMasks.resize(getHeight() * width, 0);
 
-void Block::setWidth(int width)
-{
-    this->width = width;
+    // Rasterize the slope surface: exactly one pixel row per pixel column
+    float ratio = static_cast<float>(height) / static_cast<float>(width);
+    for (int x = 0; x < getWidth(); x++)
+    {
+        int h;
+        if (collisionType == CollisionType::SLOPE_LEFT)
+        {
+            h = static_cast<int>(std::floor(ratio * (x + 0.5f)));
+        }
+        else
+        {
+            h = static_cast<int>(std::floor(-1.0f * ratio * (x + 0.5f) + (height * Level::TILE_SIZE)));
+        }
+        if (h >= 0 && h < getHeight())
+        {
+            slopeMasks[h * width + x / Level::TILE_SIZE] |= 1 << (x % Level::TILE_SIZE);
+        }
+    }
 }
@@ -1,13 +1,21 @@
 #ifndef BLOCK_HPP
 #define BLOCK_HPP
 
+#include <cstdint>
+#include <vector>
+
 /**
  * A tiled object that makes up the terrain of a level.
+ *
+ * Blocks are immutable definitions (a collision type and a size) that may be
+ * placed any number of times in any number of Layers; the layers keep track
+ * of where each placement is.
  */
 class Block
 {
     friend class Layer;
     friend class Level;
+    friend class LevelFile;
 public:
     /**
      * Collision mask templates for blocks.
@@ -22,50 +30,40 @@ public:
         WATER        /**< Block triggers water physics. */
     };
 
-    Block(CollisionType collisionType);
+    /**
+     * Constructor.
+     *
+     * @param collisionType the collision mask template of the block.
+     * @param width the width of the block, in tiles.
+     * @param height the height of the block, in tiles.
+     */
+    Block(CollisionType collisionType, int width = 1, int height = 1);
 
     virtual ~Block() {}
 
     /**
-     * Get the bottom y coordinate, in pixels.
+     * Get the shared definition of a kind of block, creating it on first use.
+     *
+     * Shared definitions live until the program exits. This is safe to call
+     * from any thread, but takes a lock, so callers placing many blocks should
+     * get the definition once and reuse it.
+     *
+     * @param collisionType the collision mask template of the block.
+     * @param width the width of the block, in tiles.
+     * @param height the height of the block, in tiles.
      */
-    int getBottom() const;
+    static const Block* get(CollisionType collisionType, int width = 1, int height = 1);
 
     /**
      * Get the height of the block, in pixels.
      */
     int getHeight() const;
 
-    /**
-     * Get the left x coordinate, in pixels.
-     */
-    int getLeft() const;
-
-    /**
-     * Get the right x coordinate, in pixels.
-     */
-    int getRight() const;
-
-    /**
-     * Get the top y coordinate, in pixels.
-     */
-    int getTop() const;
-
     /**
      * Get the width of the block, in pixels.
      */
     int getWidth() const;
 
-    /**
-     * Get the x position of the block, in pixels.
-     */
-    int getX() const;
-
-    /**
-     * Get the y position of the block, in pixels.
-     */
-    int getY() const;
-
     /**
      * Check if the block causes a collision from the bottom at a particular pixel.
      */
@@ -91,22 +89,43 @@ public:
      */
     bool hasTopCollision(int x, int y) const;
 
+private:
     /**
-     * Set the height of the block, in tiles.
-     */
-    void setHeight(int height);
-
-    /**
-     * Set the width of the block, in tiles.
+     * Collision properties of a single tile of a block. Layers keep these in
+     * a compact grid so that collision queries don't need to read the block.
      */
-    void setWidth(int width);
+    enum TileFlag : uint8_t
+    {
+        TILE_TOP_EDGE = 1 << 0,    /**< The first pixel row of the tile collides from the top. */
+        TILE_BOTTOM_EDGE = 1 << 1, /**< The last pixel row of the tile collides from the bottom. */
+        TILE_LEFT_EDGE = 1 << 2,   /**< The first pixel column of the tile collides from the left. */
+        TILE_RIGHT_EDGE = 1 << 3,  /**< The last pixel column of the tile collides from the right. */
+        TILE_SLOPE = 1 << 4,       /**< The tile may cause slope collisions. */
+        TILE_WATER = 1 << 5        /**< The tile triggers water physics. */
+    };
 
-private:
     CollisionType collisionType;
-    int positionX; /**< Position within a layer, in tiles. */
-    int positionY; /**< Position within a layer, in tiles. */
     int width;  /**< Width, in tiles. */
     int height; /**< Height, in tiles. */
+
+    /**
+     * Slope collision bitmasks, one 16-bit mask per pixel row per tile column
+     * (indexed by row * width + tile column). Empty for non-slope blocks.
+     */
+    std::vector<uint16_t> slopeMasks;
+
+    /**
+     * Get the TileFlag bits of a tile of the block.
+     *
+     * @param x the x position of the tile within the block, in tiles.
+     * @param y the y position of the tile within the block, in tiles.
+     */
+    uint8_t getTileFlags(int x, int y) const;
+
+    /**
+     * Build the slope collision bitmasks.
+     */
+    void updateSlopeMasks();
 };
 
 #endif // BLOCK_HPP
@@ -0,0 +1,72 @@
+#include "Camera.hpp"
+#include "Entity.hpp"
+#include "Level.hpp"
+
+Camera::Camera() :
+    target(nullptr),
+    positioned(false),
+    centerX(0),
+    centerY(0),
+    previousCenterX(0),
+    previousCenterY(0),
+    boundsLeft(0),
+    boundsTop(0),
+    boundsRight(0),
+    boundsBottom(0)
+{
+}
+
+int Camera::clamp(int start, int size, int boundsStart, int boundsEnd)
+{
+    // Levels smaller than the camera are aligned to its start
+    if (start + size > boundsEnd + 1)
+    {
+        start = boundsEnd + 1 - size;
+    }
+    if (start < boundsStart)
+    {
+        start = boundsStart;
+    }
+    return start;
+}
+
+int Camera::getLeft(int width, Fixed interpolation) const
+{
+    int x = interpolate(previousCenterX, centerX, interpolation).floor() - width / 2;
+    return clamp(x, width, boundsLeft, boundsRight);
+}
+
+int Camera::getTop(int height, Fixed interpolation) const
+{
+    int y = interpolate(previousCenterY, centerY, interpolation).floor() - height / 2;
+    return clamp(y, height, boundsTop, boundsBottom);
+}
+
+void Camera::setTarget(const Entity* target)
+{
+    this->target = target;
+}
+
+void Camera::update(const Level& level)
+{
+    previousCenterX = centerX;
+    previousCenterY = centerY;
+    if (target)
+    {
+        centerX = target->getCenterX();
+        centerY = target->getCenterY();
+    }
+
+    // Don't sweep in from the origin when first placed
+    if (!positioned)
+    {
+        previousCenterX = centerX;
+        previousCenterY = centerY;
+        positioned = true;
+    }
+
+    boundsLeft = level.getLeft();
+    boundsTop = level.getTop();
+    boundsRight = level.getRight();
+    boundsBottom = level.getBottom();
+}
@@ -0,0 +1,64 @@
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+
+#include "../util/Fixed.hpp"
+
+class Entity;
+class Level;
+
+/**
+ * Tracks the part of a Level shown on the screen, following a target Entity
+ * and staying within the bounds of the level.
+ *
+ * The camera is moved along with the level's updates and interpolated between
+ * them like the level's entities and layers.
+ */
+class Camera
+{
+public:
+    Camera();
+
+    /**
+     * Get the left edge of the camera rectangle, in pixels.
+     *
+     * @param width the width of the camera rectangle, in pixels.
+     * @param interpolation how far to interpolate the camera from its position
+     * before the last update (0) to its current position (1).
+     */
+    int getLeft(int width, Fixed interpolation) const;
+
+    /**
+     * Get the top edge of the camera rectangle, in pixels.
+     *
+     * @param height the height of the camera rectangle, in pixels.
+     * @param interpolation how far to interpolate the camera from its position
+     * before the last update (0) to its current position (1).
+     */
+    int getTop(int height, Fixed interpolation) const;
+
+    /**
+     * Set the entity that the camera is centered on, or nullptr to stop following.
+     */
+    void setTarget(const Entity* target);
+
+    /**
+     * Move the camera to its target, after the level has been updated.
+     */
+    void update(const Level& level);
+
+private:
+    const Entity* target;
+    bool positioned; /**< Whether the camera has been placed by an update yet. */
+    Fixed centerX; /**< X position of the center, in pixels. */
+    Fixed centerY; /**< Y position of the center, in pixels. */
+    Fixed previousCenterX; /**< X position of the center before the last update, in pixels. */
+    Fixed previousCenterY; /**< Y position of the center before the last update, in pixels. */
+    int boundsLeft;
+    int boundsTop;
+    int boundsRight;
+    int boundsBottom;
+
+    static int clamp(int start, int size, int boundsStart, int boundsEnd);
+};
+
+#endif // CAMERA_HPP
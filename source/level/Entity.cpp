@@ -1,34 +1,54 @@
-#include <cmath>
-
 #include "Entity.hpp"
+#include "EntityStore.hpp"
 #include "Level.hpp"
 
 Entity::Entity() :
     level(nullptr),
+    store(nullptr),
+    index(-1),
     width(Level::TILE_SIZE),
     height(Level::TILE_SIZE),
-    positionX(0.0f),
-    positionY(0.0f),
-    velocityX(0.0f),
-    velocityY(0.0f),
-    accelerationX(0.0f),
-    accelerationY(0.0f)
+    positionX(0),
+    positionY(0),
+    velocityX(0),
+    velocityY(0),
+    accelerationX(0),
+    accelerationY(0),
+    groundLayer(nullptr),
+    underwater(false),
+    atSurfaceOfWater(false),
+    contactX(0),
+    contactY(0),
+    contactRevision(0),
+    contactLayerRevision(0),
+    contactLayerCount(-1)
 {
 }
 
 int Entity::getBottom() const
 {
-    return getY() + height - 1;
+    return getY() + getHeight() - 1;
 }
 
 int Entity::getCenterX() const
 {
-    return getX() + width / 2;
+    return getX() + getWidth() / 2;
 }
 
 int Entity::getCenterY() const
 {
-    return getY() + height / 2;
+    return getY() + getHeight() / 2;
+}
+
+const Layer* Entity::getGroundLayer() const
+{
+    level->updateEntityContacts(*this);
+    return groundLayer;
+}
+
+int Entity::getHeight() const
+{
+    return (store != nullptr) ? store->height[index] : height;
 }
 
 int Entity::getLeft() const
@@ -48,7 +68,7 @@ const Level& Entity::getLevel() const
 
 int Entity::getRight() const
 {
-    return getX() + width - 1;
+    return getX() + getWidth() - 1;
 }
 
 int Entity::getTop() const
@@ -56,62 +76,121 @@ int Entity::getTop() const
     return getY();
 }
 
-float Entity::getVelocityX() const
+Fixed Entity::getVelocityX() const
 {
-    return velocityX;
+    return (store != nullptr) ? store->velocityX[index] : velocityX;
 }
 
-float Entity::getVelocityY() const
+Fixed Entity::getVelocityY() const
 {
-    return velocityY;
+    return (store != nullptr) ? store->velocityY[index] : velocityY;
+}
+
+int Entity::getWidth() const
+{
+    return (store != nullptr) ? store->width[index] : width;
 }
 
 int Entity::getX() const
 {
-    return static_cast<int>(std::floor(positionX));
+    return (store != nullptr) ? store->positionX[index].floor() : positionX.floor();
 }
 
 int Entity::getY() const
 {
-    return static_cast<int>(std::floor(positionY));
+    return (store != nullptr) ? store->positionY[index].floor() : positionY.floor();
+}
+
+bool Entity::isAtSurfaceOfWater() const
+{
+    level->updateEntityContacts(*this);
+    return atSurfaceOfWater;
 }
 
 bool Entity::isOnGround() const
 {
-    return level->isEntityOnGround(*this);
+    level->updateEntityContacts(*this);
+    return groundLayer != nullptr;
 }
 
 bool Entity::isUnderwater() const
 {
-    return level->isUnderwaterAt(getCenterX(), getCenterY());
+    level->updateEntityContacts(*this);
+    return underwater;
 }
 
-void Entity::setAccelerationX(float ax)
+void Entity::setAccelerationX(Fixed ax)
 {
-    accelerationX = ax;
+    if (store != nullptr)
+    {
+        store->accelerationX[index] = ax;
+    }
+    else
+    {
+        accelerationX = ax;
+    }
 }
 
-void Entity::setAccelerationY(float ay)
+void Entity::setAccelerationY(Fixed ay)
 {
-    accelerationY = ay;
+    if (store != nullptr)
+    {
+        store->accelerationY[index] = ay;
+    }
+    else
+    {
+        accelerationY = ay;
+    }
 }
 
-void Entity::setVelocityX(float vx)
+void Entity::setVelocityX(Fixed vx)
 {
-    velocityX = vx;
+    if (store != nullptr)
+    {
+        store->velocityX[index] = vx;
+    }
+    else
+    {
+        velocityX = vx;
+    }
 }
 
-void Entity::setVelocityY(float vy)
+void Entity::setVelocityY(Fixed vy)
 {
-    velocityY = vy;
+    if (store != nullptr)
+    {
+        store->velocityY[index] = vy;
+    }
+    else
+    {
+        velocityY = vy;
+    }
 }
 
-void Entity::setX(float x)
+void Entity::setX(Fixed x)
 {
-    positionX = x;
+    if (store != nullptr)
+    {
+        store->positionX[index] = x;
+        store->previousPositionX[index] = x;
+        level->entityGrid.update(this);
+    }
+    else
+    {
+        positionX = x;
+    }
 }
 
-void Entity::setY(float y)
+void Entity::setY(Fixed y)
 {
-    positionY = y;
+    if (store != nullptr)
+    {
+        store->positionY[index] = y;
+        store->previousPositionY[index] = y;
+        level->entityGrid.update(this);
+    }
+    else
+    {
+        positionY = y;
+    }
 }
@@ -1,6 +1,10 @@
 #ifndef ENTITY_HPP
 #define ENTITY_HPP
 
+#include "../util/Fixed.hpp"
+
+class EntityStore;
+class Layer;
 class Level;
 
 /**
@@ -8,6 +12,7 @@ class Level;
  */
 class Entity
 {
+    friend class EntityStore;
     friend class Level;
 public:
     Entity();
@@ -28,6 +33,16 @@ public:
      */
     int getCenterY() const;
 
+    /**
+     * Get the layer that the entity is standing on, or nullptr if it is in the air.
+     */
+    const Layer* getGroundLayer() const;
+
+    /**
+     * Get the height of the entity's bounding box, in pixels.
+     */
+    int getHeight() const;
+
     /**
      * Get the left x coordinate of the entity's bounding box, in pixels.
      */
@@ -52,12 +67,17 @@ public:
     /**
      * Get the x velocity of the entity.
      */
-    float getVelocityX() const;
+    Fixed getVelocityX() const;
 
     /**
      * Get the y velocity of the entity.
      */
-    float getVelocityY() const;
+    Fixed getVelocityY() const;
+
+    /**
+     * Get the width of the entity's bounding box, in pixels.
+     */
+    int getWidth() const;
 
     /**
      * Get the x position of the enity, in pixels.
@@ -69,6 +89,12 @@ public:
      */
     int getY() const;
 
+    /**
+     * Check if the entity is at the surface of a body of water (i.e. its
+     * center is underwater but its top is not).
+     */
+    bool isAtSurfaceOfWater() const;
+
     /**
      * Check if the entity is on the ground (i.e. not in the air).
      */
@@ -82,32 +108,38 @@ public:
     /**
      * Set the x acceleration of an entity.
      */
-    void setAccelerationX(float ax);
+    void setAccelerationX(Fixed ax);
 
     /**
      * Set the y acceleration of an entity.
      */
-    void setAccelerationY(float ay);
+    void setAccelerationY(Fixed ay);
 
     /**
      * Set the x velocity of an entity.
      */
-    void setVelocityX(float vx);
+    void setVelocityX(Fixed vx);
 
     /**
      * Set the y velocity of an entity.
      */
-    void setVelocityY(float vy);
+    void setVelocityY(Fixed vy);
 
     /**
-     * Set the x position of an entity.
+     * Set the x position of an entity, without interpolating from the old one.
+     *
+     * The level's entity grid is updated immediately, so the entity is found
+     * at its new position before the next update.
      */
-    void setX(float x);
+    void setX(Fixed x);
 
     /**
-     * Set the y position of an entity.
+     * Set the y position of an entity, without interpolating from the old one.
+     *
+     * The level's entity grid is updated immediately, so the entity is found
+     * at its new position before the next update.
      */
-    void setY(float y);
+    void setY(Fixed y);
 
 protected:
     /**
@@ -117,14 +149,28 @@ protected:
 
 private:
     Level* level; /**< The level that the entity belongs to. */
+    EntityStore* store; /**< The store holding the entity's state once it belongs to a level. */
+    int index; /**< Index of the entity in the store. */
+
+    // State of the entity while it does not belong to a level
     int width;  /**< Width, in pixels. */
     int height; /**< Height, in pixels. */
-    float positionX; /**< X position, in pixels. */
-    float positionY; /**< Y position, in pixels. */
-    float velocityX; /**< X velocity, in pixels/frame. */
-    float velocityY; /**< Y velocity, in pixels/frame. */
-    float accelerationX; /**< X acceleration, in pixels/frame/frame. */
-    float accelerationY; /**< Y acceleration, in pixels/frame/frame. */
+    Fixed positionX; /**< X position, in pixels. */
+    Fixed positionY; /**< Y position, in pixels. */
+    Fixed velocityX; /**< X velocity, in pixels/frame. */
+    Fixed velocityY; /**< Y velocity, in pixels/frame. */
+    Fixed accelerationX; /**< X acceleration, in pixels/frame/frame. */
+    Fixed accelerationY; /**< Y acceleration, in pixels/frame/frame. */
+
+    // Contacts with the level, cached by Level::updateEntityContacts()
+    mutable const Layer* groundLayer; /**< Layer the entity is standing on, or nullptr. */
+    mutable bool underwater; /**< Whether the entity's center is underwater. */
+    mutable bool atSurfaceOfWater; /**< Whether the entity is at the surface of a body of water. */
+    mutable int contactX; /**< X position, in pixels, that the contacts were found at. */
+    mutable int contactY; /**< Y position, in pixels, that the contacts were found at. */
+    mutable unsigned long long contactRevision; /**< Level layer revision that the contacts were last checked at, or 0. */
+    mutable unsigned long long contactLayerRevision; /**< Latest change to the layers around the entity when the contacts were found. */
+    mutable int contactLayerCount; /**< Number of layers around the entity when the contacts were found, or -1. */
 };
 
 #endif // ENTITY_HPP
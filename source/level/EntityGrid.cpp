@@ -0,0 +1,157 @@
+#include <algorithm>
+
+#include "Entity.hpp"
+#include "EntityGrid.hpp"
+
+void EntityGrid::addCellEntries(uint64_t key, const std::vector<Entry>& entries, const CellRange& area, std::vector<Entity*>& entities)
+{
+    for (auto& entry : entries)
+    {
+        // Entities that span several cells are only reported from the first
+        // of their cells inside the area
+        const CellRange& range = entry.range;
+        if (range.left <= area.right && range.right >= area.left &&
+            range.top <= area.bottom && range.bottom >= area.top &&
+            key == getCellKey(std::max(area.left, range.left), std::max(area.top, range.top)))
+        {
+            entities.push_back(entry.entity);
+        }
+    }
+}
+
+void EntityGrid::addToCells(Entity* entity, const CellRange& range)
+{
+    for (int y = range.top; y <= range.bottom; y++)
+    {
+        for (int x = range.left; x <= range.right; x++)
+        {
+            cells[getCellKey(x, y)].push_back({entity, range});
+        }
+    }
+}
+
+int EntityGrid::getCell(int coordinate)
+{
+    // Round towards negative infinity so that negative positions get their own cells
+    if (coordinate < 0)
+    {
+        return (coordinate + 1) / CELL_SIZE - 1;
+    }
+    return coordinate / CELL_SIZE;
+}
+
+uint64_t EntityGrid::getCellKey(int x, int y)
+{
+    // Shift the bits of x unsigned, since shifting a negative value is undefined
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+EntityGrid::CellRange EntityGrid::getCellRange(const Entity& entity)
+{
+    return {
+        getCell(entity.getLeft()),
+        getCell(entity.getTop()),
+        getCell(entity.getRight()),
+        getCell(entity.getBottom())
+    };
+}
+
+void EntityGrid::insert(Entity* entity)
+{
+    CellRange range = getCellRange(*entity);
+    entityRanges[entity] = range;
+    addToCells(entity, range);
+}
+
+void EntityGrid::query(int left, int top, int right, int bottom, std::vector<Entity*>& entities) const
+{
+    CellRange area = {getCell(left), getCell(top), getCell(right), getCell(bottom)};
+
+    // Large areas, such as wide moving layers, visit the cells that hold
+    // entities instead of looking up every cell in the area
+    int64_t areaCellCount = (static_cast<int64_t>(area.right) - area.left + 1) * (static_cast<int64_t>(area.bottom) - area.top + 1);
+    if (areaCellCount > static_cast<int64_t>(cells.size()))
+    {
+        for (auto& cell : cells)
+        {
+            addCellEntries(cell.first, cell.second, area, entities);
+        }
+        return;
+    }
+
+    for (int y = area.top; y <= area.bottom; y++)
+    {
+        for (int x = area.left; x <= area.right; x++)
+        {
+            uint64_t key = getCellKey(x, y);
+            auto cell = cells.find(key);
+            if (cell != cells.end())
+            {
+                addCellEntries(key, cell->second, area, entities);
+            }
+        }
+    }
+}
+
+void EntityGrid::remove(Entity* entity)
+{
+    auto range = entityRanges.find(entity);
+    if (range == entityRanges.end())
+    {
+        return;
+    }
+    removeFromCells(entity, range->second);
+    entityRanges.erase(range);
+}
+
+void EntityGrid::removeFromCells(Entity* entity, const CellRange& range)
+{
+    for (int y = range.top; y <= range.bottom; y++)
+    {
+        for (int x = range.left; x <= range.right; x++)
+        {
+            auto cell = cells.find(getCellKey(x, y));
+            if (cell == cells.end())
+            {
+                continue;
+            }
+            auto& entries = cell->second;
+            for (size_t i = 0; i < entries.size(); i++)
+            {
+                if (entries[i].entity == entity)
+                {
+                    entries[i] = entries.back();
+                    entries.pop_back();
+                    break;
+                }
+            }
+
+            // Drop empty cells, so that the map only holds occupied ones
+            if (entries.empty())
+            {
+                cells.erase(cell);
+            }
+        }
+    }
+}
+
+void EntityGrid::update(Entity* entity)
+{
+    auto range = entityRanges.find(entity);
+    if (range == entityRanges.end())
+    {
+        return;
+    }
+
+    // Only touch the cells if the entity moved into a different set of them
+    CellRange newRange = getCellRange(*entity);
+    CellRange& oldRange = range->second;
+    if (newRange.left == oldRange.left && newRange.top == oldRange.top &&
+        newRange.right == oldRange.right && newRange.bottom == oldRange.bottom)
+    {
+        return;
+    }
+    removeFromCells(entity, oldRange);
+    addToCells(entity, newRange);
+    oldRange = newRange;
+}
@@ -0,0 +1,78 @@
+#ifndef ENTITYGRID_HPP
+#define ENTITYGRID_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Entity;
+
+/**
+ * A uniform grid over the bounding boxes of Entities, used to find the
+ * entities near an area of a Level without scanning all of them.
+ */
+class EntityGrid
+{
+public:
+    /**
+     * The size of a grid cell, in pixels.
+     */
+    static constexpr int CELL_SIZE = 64;
+
+    /**
+     * Add an entity to the grid.
+     */
+    void insert(Entity* entity);
+
+    /**
+     * Find all entities whose bounding boxes may overlap a rectangle.
+     *
+     * Each entity is reported once, in no particular order. Takes time in
+     * proportion to the cells in the rectangle, or to the cells that hold
+     * entities if there are fewer of those.
+     *
+     * @param left the left coordinate of the rectangle, in pixels.
+     * @param top the top coordinate of the rectangle, in pixels.
+     * @param right the right coordinate of the rectangle (inclusive), in pixels.
+     * @param bottom the bottom coordinate of the rectangle (inclusive), in pixels.
+     * @param entities the list to append the entities to.
+     */
+    void query(int left, int top, int right, int bottom, std::vector<Entity*>& entities) const;
+
+    /**
+     * Remove an entity from the grid.
+     */
+    void remove(Entity* entity);
+
+    /**
+     * Move an entity to the cells its bounding box currently covers.
+     */
+    void update(Entity* entity);
+
+private:
+    struct CellRange
+    {
+        int left;
+        int top;
+        int right;
+        int bottom;
+    };
+
+    struct Entry
+    {
+        Entity* entity;
+        CellRange range;
+    };
+
+    std::unordered_map<uint64_t, std::vector<Entry>> cells; /**< Entries of each cell that holds entities. */
+    std::unordered_map<Entity*, CellRange> entityRanges;
+
+    static void addCellEntries(uint64_t key, const std::vector<Entry>& entries, const CellRange& area, std::vector<Entity*>& entities);
+    void addToCells(Entity* entity, const CellRange& range);
+    static int getCell(int coordinate);
+    static uint64_t getCellKey(int x, int y);
+    static CellRange getCellRange(const Entity& entity);
+    void removeFromCells(Entity* entity, const CellRange& range);
+};
+
+#endif // ENTITYGRID_HPP
@@ -0,0 +1,72 @@
+#include "Entity.hpp"
+#include "EntityStore.hpp"
+
+void EntityStore::add(Entity* entity)
+{
+    entity->store = this;
+    entity->index = entities.size();
+
+    entities.push_back(entity);
+    width.push_back(entity->width);
+    height.push_back(entity->height);
+    positionX.push_back(entity->positionX);
+    positionY.push_back(entity->positionY);
+    previousPositionX.push_back(entity->positionX);
+    previousPositionY.push_back(entity->positionY);
+    velocityX.push_back(entity->velocityX);
+    velocityY.push_back(entity->velocityY);
+    accelerationX.push_back(entity->accelerationX);
+    accelerationY.push_back(entity->accelerationY);
+}
+
+void EntityStore::remove(Entity* entity)
+{
+    int index = entity->index;
+
+    // Hand the state back to the entity
+    entity->width = width[index];
+    entity->height = height[index];
+    entity->positionX = positionX[index];
+    entity->positionY = positionY[index];
+    entity->velocityX = velocityX[index];
+    entity->velocityY = velocityY[index];
+    entity->accelerationX = accelerationX[index];
+    entity->accelerationY = accelerationY[index];
+    entity->store = nullptr;
+    entity->index = -1;
+
+    // Fill the gap with the last entity
+    int last = entities.size() - 1;
+    if (index != last)
+    {
+        entities[index] = entities[last];
+        width[index] = width[last];
+        height[index] = height[last];
+        positionX[index] = positionX[last];
+        positionY[index] = positionY[last];
+        previousPositionX[index] = previousPositionX[last];
+        previousPositionY[index] = previousPositionY[last];
+        velocityX[index] = velocityX[last];
+        velocityY[index] = velocityY[last];
+        accelerationX[index] = accelerationX[last];
+        accelerationY[index] = accelerationY[last];
+        entities[index]->index = index;
+    }
+
+    entities.pop_back();
+    width.pop_back();
+    height.pop_back();
+    positionX.pop_back();
+    positionY.pop_back();
+    previousPositionX.pop_back();
+    previousPositionY.pop_back();
+    velocityX.pop_back();
+    velocityY.pop_back();
+    accelerationX.pop_back();
+    accelerationY.pop_back();
+}
+
+int EntityStore::size() const
+{
+    return entities.size();
+}
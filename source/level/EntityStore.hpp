@@ -0,0 +1,51 @@
+#ifndef ENTITYSTORE_HPP
+#define ENTITYSTORE_HPP
+
+#include <vector>
+
+#include "../util/Fixed.hpp"
+
+class Entity;
+
+/**
+ * Contiguous storage for the physical state of the Entities in a Level,
+ * with one array per property so that physics passes can walk them linearly.
+ *
+ * The Entity objects themselves act as stable handles: each one knows its
+ * index in the store, which is kept up to date as other entities are removed.
+ */
+class EntityStore
+{
+    friend class Entity;
+    friend class Level;
+public:
+    /**
+     * Move an entity's state into the store.
+     */
+    void add(Entity* entity);
+
+    /**
+     * Move an entity's state out of the store.
+     */
+    void remove(Entity* entity);
+
+    /**
+     * Get the number of entities in the store.
+     */
+    int size() const;
+
+private:
+    std::vector<Entity*> entities;
+    std::vector<int> width;  /**< Widths, in pixels. */
+    std::vector<int> height; /**< Heights, in pixels. */
+    std::vector<Fixed> positionX; /**< X positions, in pixels. */
+    std::vector<Fixed> positionY; /**< Y positions, in pixels. */
+    std::vector<Fixed> previousPositionX; /**< X positions before the last update, in pixels. */
+    std::vector<Fixed> previousPositionY; /**< Y positions before the last update, in pixels. */
+    std::vector<Fixed> velocityX; /**< X velocities, in pixels/frame. */
+    std::vector<Fixed> velocityY; /**< Y velocities, in pixels/frame. */
+    std::vector<Fixed> accelerationX; /**< X accelerations, in pixels/frame/frame. */
+    std::vector<Fixed> accelerationY; /**< Y accelerations, in pixels/frame/frame. */
+};
+
+#endif // ENTITYSTORE_HPP
@@ -1,86 +1,150 @@
-#include <cmath>
-#include <set>
+#include <algorithm>
+
+#include "../util/Arena.hpp"
 
 #include "Block.hpp"
 #include "Layer.hpp"
 #include "Level.hpp"
 
-Layer::Layer(int width, int height) :
+Layer::Chunk Layer::emptyChunk = {};
+
+Layer::Layer(int width, int height, Arena* arena) :
     width(width),
     height(height),
-    positionX(0.0f),
-    positionY(0.0f),
-    velocityX(0.0f),
-    velocityY(0.0f)
+    positionX(0),
+    positionY(0),
+    previousPositionX(0),
+    previousPositionY(0),
+    velocityX(0),
+    velocityY(0),
+    revision(1),
+    changeRevision(0),
+    arena(arena),
+    level(nullptr),
+    chunksWide((width + CHUNK_SIZE - 1) / CHUNK_SIZE)
 {
-    blocks.resize(width * height, nullptr);
+    chunks.resize(chunksWide * ((height + CHUNK_SIZE - 1) / CHUNK_SIZE), &emptyChunk);
 }
 
 Layer::~Layer()
 {
-    // Find all blocks in the layer
-    std::set<Block*> blockSet;
-    for (auto block : blocks)
+    // Blocks are not owned by the layer, and chunks from an arena are freed
+    // along with it, so only heap chunks need freeing
+    if (arena != nullptr)
+    {
+        return;
+    }
+    for (auto chunk : chunks)
     {
-        if (block != nullptr)
+        if (chunk != &emptyChunk)
         {
-            blockSet.insert(block);
+            delete chunk;
         }
     }
+}
 
-    // And then free them
-    for (auto block : blockSet)
+bool Layer::anyTileInColumn(int x, int top, int bottom, uint8_t flag) const
+{
+    // Convert to local coordinates and clip to the layer
+    x -= getX();
+    top -= getY();
+    bottom -= getY();
+    if (x < 0 || x >= width * Level::TILE_SIZE || bottom < 0 || top >= height * Level::TILE_SIZE)
     {
-        delete block;
+        return false;
     }
+    top = std::max(top, 0);
+    bottom = std::min(bottom, height * Level::TILE_SIZE - 1);
+
+    int tileX = x / Level::TILE_SIZE;
+    for (int tileY = top / Level::TILE_SIZE; tileY <= bottom / Level::TILE_SIZE; tileY++)
+    {
+        if (getTileFlags(tileX, tileY) & flag)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
-void Layer::addBlock(int x, int y, Block* block)
+bool Layer::anyTileInRow(int left, int right, int y, uint8_t flag) const
 {
-    if (block == nullptr)
+    // Convert to local coordinates and clip to the layer
+    left -= getX();
+    right -= getX();
+    y -= getY();
+    if (y < 0 || y >= height * Level::TILE_SIZE || right < 0 || left >= width * Level::TILE_SIZE)
+    {
+        return false;
+    }
+    left = std::max(left, 0);
+    right = std::min(right, width * Level::TILE_SIZE - 1);
+
+    int tileY = y / Level::TILE_SIZE;
+    for (int tileX = left / Level::TILE_SIZE; tileX <= right / Level::TILE_SIZE; tileX++)
+    {
+        if (getTileFlags(tileX, tileY) & flag)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Layer::addBlock(int x, int y, const Block* block)
+{
+    if (block == nullptr || block->width > MAX_BLOCK_SIZE || block->height > MAX_BLOCK_SIZE)
     {
         return;
     }
 
-    block->positionX = x;
-    block->positionY = y;
+    // Only visit the tiles of the block that are inside the layer. Tiles
+    // outside it are dropped.
+    int left = static_cast<int>(std::min<int64_t>(block->width, std::max<int64_t>(0, -static_cast<int64_t>(x))));
+    int top = static_cast<int>(std::min<int64_t>(block->height, std::max<int64_t>(0, -static_cast<int64_t>(y))));
+    int right = static_cast<int>(std::min<int64_t>(block->width, static_cast<int64_t>(width) - x));
+    int bottom = static_cast<int>(std::min<int64_t>(block->height, static_cast<int64_t>(height) - y));
+    if (left >= right || top >= bottom)
+    {
+        return;
+    }
 
-    for (int yIndex = 0; yIndex < block->height; yIndex++)
+    placements.push_back({x, y, block});
+    revision++;
+    if (level != nullptr)
+    {
+        level->markLayerChanged(*this);
+    }
+    for (int yIndex = top; yIndex < bottom; yIndex++)
     {
-        for (int xIndex = 0; xIndex < block->width; xIndex++)
+        for (int xIndex = left; xIndex < right; xIndex++)
         {
             int xOffset = x + xIndex;
             int yOffset = y + yIndex;
-            if (xOffset < 0 || xOffset >= width || yOffset < 0 || yOffset >= height)
+
+            Chunk*& chunk = chunks[(yOffset / CHUNK_SIZE) * chunksWide + xOffset / CHUNK_SIZE];
+            if (chunk == &emptyChunk)
             {
-                // TODO: should this be an error if we try to insert a block out of bounds?
-                continue;
+                chunk = (arena != nullptr) ? arena->create<Chunk>() : new Chunk();
             }
-
-            blocks[yOffset * width + xOffset] = block;
+            int tile = (yOffset % CHUNK_SIZE) * CHUNK_SIZE + xOffset % CHUNK_SIZE;
+            chunk->blocks[tile] = block;
+            chunk->flags[tile] = block->getTileFlags(xIndex, yIndex);
+            chunk->offsets[tile] = {static_cast<uint16_t>(xIndex), static_cast<uint16_t>(yIndex)};
         }
     }
 }
 
-Block* Layer::getBlock(int x, int y)
-{
-    if (x < 0 || x >= width || y < 0 || y >= height)
-    {
-        return nullptr;
-    }
-    return blocks[y * width + x];
-}
-
 const Block* Layer::getBlock(int x, int y) const
 {
     if (x < 0 || x >= width || y < 0 || y >= height)
     {
         return nullptr;
     }
-    return blocks[y * width + x];
+    return getTile(x, y);
 }
 
-Block* Layer::getBlockAt(int x, int y)
+const Block* Layer::getBlockAt(int x, int y) const
 {
     // Convert to local coordinates
     x -= getX();
@@ -92,80 +156,200 @@ Block* Layer::getBlockAt(int x, int y)
     return getBlock(x / Level::TILE_SIZE, y / Level::TILE_SIZE);
 }
 
-const Block* Layer::getBlockAt(int x, int y) const
+int Layer::getBottom() const
 {
-    // Convert to local coordinates
-    x -= getX();
-    y -= getY();
-    if (x < 0 || y < 0)
-    {
-        return nullptr;
-    }
-    return getBlock(x / Level::TILE_SIZE, y / Level::TILE_SIZE);
+    return getY() + height * Level::TILE_SIZE - 1;
 }
 
-int Layer::getX() const
+int Layer::getBottomCollisionDistance(int left, int right, int y, int maxDistance) const
 {
-    return static_cast<int>(std::floor(positionX));
+    // Bottom edges of blocks only lie on the last pixel row of a tile
+    int localY = y - getY();
+    if (localY < 0)
+    {
+        return maxDistance;
+    }
+    int row = std::min(localY + 1, height * Level::TILE_SIZE) / Level::TILE_SIZE * Level::TILE_SIZE - 1;
+    for (; row >= 0 && localY - row < maxDistance; row -= Level::TILE_SIZE)
+    {
+        if (hasBottomCollisionInRow(left, right, row + getY()))
+        {
+            return localY - row;
+        }
+    }
+    return maxDistance;
 }
 
-int Layer::getY() const
+int Layer::getLeft() const
 {
-    return static_cast<int>(std::floor(positionY));
+    return getX();
 }
 
-bool Layer::hasBottomCollision(int x, int y) const
+int Layer::getLeftCollisionDistance(int x, int top, int bottom, int maxDistance) const
 {
-    auto block = getBlockAt(x, y);
-    if (block == nullptr)
+    // Left edges of blocks only lie on the first pixel column of a tile
+    int localX = x - getX();
+    int column = (localX <= 0) ? 0 : (localX + Level::TILE_SIZE - 1) / Level::TILE_SIZE * Level::TILE_SIZE;
+    for (; column < width * Level::TILE_SIZE && column - localX < maxDistance; column += Level::TILE_SIZE)
     {
-        return false;
+        if (hasLeftCollisionInColumn(column + getX(), top, bottom))
+        {
+            return column - localX;
+        }
     }
+    return maxDistance;
+}
 
-    // Translate to local coordinates
-    x -= getX();
-    y -= getY();
+int Layer::getRight() const
+{
+    return getX() + width * Level::TILE_SIZE - 1;
+}
 
-    // Translate to block coordinates
-    return block->hasBottomCollision(x - block->getX(), y - block->getY());
+int Layer::getRightCollisionDistance(int x, int top, int bottom, int maxDistance) const
+{
+    // Right edges of blocks only lie on the last pixel column of a tile
+    int localX = x - getX();
+    if (localX < 0)
+    {
+        return maxDistance;
+    }
+    int column = std::min(localX + 1, width * Level::TILE_SIZE) / Level::TILE_SIZE * Level::TILE_SIZE - 1;
+    for (; column >= 0 && localX - column < maxDistance; column -= Level::TILE_SIZE)
+    {
+        if (hasRightCollisionInColumn(column + getX(), top, bottom))
+        {
+            return localX - column;
+        }
+    }
+    return maxDistance;
 }
 
-bool Layer::hasLeftCollision(int x, int y) const
+int Layer::getSlopeCollisionDistance(int x, int y, int maxDistance) const
 {
-    auto block = getBlockAt(x, y);
-    if (block == nullptr)
+    int localX = x - getX();
+    int localY = y - getY();
+    if (localX < 0 || localX >= width * Level::TILE_SIZE)
     {
-        return false;
+        return maxDistance;
     }
 
-    // Translate to local coordinates
-    x -= getX();
-    y -= getY();
+    // Walk down the column a tile at a time, only testing pixels of slope tiles
+    int tileX = localX / Level::TILE_SIZE;
+    for (int row = std::max(localY, 0); row < height * Level::TILE_SIZE && row - localY < maxDistance; )
+    {
+        int tileEnd = (row / Level::TILE_SIZE + 1) * Level::TILE_SIZE;
+        if (!(getTileFlags(tileX, row / Level::TILE_SIZE) & Block::TILE_SLOPE))
+        {
+            row = tileEnd;
+            continue;
+        }
+        const Block* block = getTile(tileX, row / Level::TILE_SIZE);
+        TileOffset offset = getTileOffset(tileX, row / Level::TILE_SIZE);
+        int blockX = offset.x * Level::TILE_SIZE + localX % Level::TILE_SIZE;
+        int blockTop = (row / Level::TILE_SIZE - offset.y) * Level::TILE_SIZE;
+        for (; row < tileEnd && row - localY < maxDistance; row++)
+        {
+            if (block->hasSlopeCollision(blockX, row - blockTop))
+            {
+                return row - localY;
+            }
+        }
+    }
+    return maxDistance;
+}
 
-    // Translate to block coordinates
-    return block->hasLeftCollision(x - block->getX(), y - block->getY());
+const Block* Layer::getTile(int x, int y) const
+{
+    // Tile positions inside the layer are never negative, so shifts and masks
+    // can stand in for division
+    const Chunk* chunk = chunks[(y >> CHUNK_SHIFT) * chunksWide + (x >> CHUNK_SHIFT)];
+    return chunk->blocks[((y & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) + (x & (CHUNK_SIZE - 1))];
 }
 
-bool Layer::hasRightCollision(int x, int y) const
+uint8_t Layer::getTileFlags(int x, int y) const
 {
-    auto block = getBlockAt(x, y);
-    if (block == nullptr)
+    const Chunk* chunk = chunks[(y >> CHUNK_SHIFT) * chunksWide + (x >> CHUNK_SHIFT)];
+    return chunk->flags[((y & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) + (x & (CHUNK_SIZE - 1))];
+}
+
+Layer::TileOffset Layer::getTileOffset(int x, int y) const
+{
+    const Chunk* chunk = chunks[(y >> CHUNK_SHIFT) * chunksWide + (x >> CHUNK_SHIFT)];
+    return chunk->offsets[((y & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) + (x & (CHUNK_SIZE - 1))];
+}
+
+int Layer::getTop() const
+{
+    return getY();
+}
+
+int Layer::getTopCollisionDistance(int left, int right, int y, int maxDistance) const
+{
+    // Top edges of blocks only lie on the first pixel row of a tile
+    int localY = y - getY();
+    int row = (localY <= 0) ? 0 : (localY + Level::TILE_SIZE - 1) / Level::TILE_SIZE * Level::TILE_SIZE;
+    for (; row < height * Level::TILE_SIZE && row - localY < maxDistance; row += Level::TILE_SIZE)
     {
-        return false;
+        if (hasTopCollisionInRow(left, right, row + getY()))
+        {
+            return row - localY;
+        }
     }
+    return maxDistance;
+}
 
-    // Translate to local coordinates
-    x -= getX();
-    y -= getY();
+int Layer::getX() const
+{
+    return positionX.floor();
+}
 
-    // Translate to block coordinates
-    return block->hasRightCollision(x - block->getX(), y - block->getY());
+int Layer::getY() const
+{
+    return positionY.floor();
+}
+
+bool Layer::hasBottomCollision(int x, int y) const
+{
+    // Bottom edges of blocks only lie on the last pixel row of a tile
+    return (y - getY()) % Level::TILE_SIZE == Level::TILE_SIZE - 1 && hasTileFlagAt(x, y, Block::TILE_BOTTOM_EDGE);
+}
+
+bool Layer::hasBottomCollisionInRow(int left, int right, int y) const
+{
+    // Bottom edges of blocks only lie on the last pixel row of a tile
+    int localY = y - getY();
+    return localY % Level::TILE_SIZE == Level::TILE_SIZE - 1 && anyTileInRow(left, right, y, Block::TILE_BOTTOM_EDGE);
+}
+
+bool Layer::hasLeftCollision(int x, int y) const
+{
+    // Left edges of blocks only lie on the first pixel column of a tile
+    return (x - getX()) % Level::TILE_SIZE == 0 && hasTileFlagAt(x, y, Block::TILE_LEFT_EDGE);
+}
+
+bool Layer::hasLeftCollisionInColumn(int x, int top, int bottom) const
+{
+    // Left edges of blocks only lie on the first pixel column of a tile
+    int localX = x - getX();
+    return localX % Level::TILE_SIZE == 0 && anyTileInColumn(x, top, bottom, Block::TILE_LEFT_EDGE);
+}
+
+bool Layer::hasRightCollision(int x, int y) const
+{
+    // Right edges of blocks only lie on the last pixel column of a tile
+    return (x - getX()) % Level::TILE_SIZE == Level::TILE_SIZE - 1 && hasTileFlagAt(x, y, Block::TILE_RIGHT_EDGE);
+}
+
+bool Layer::hasRightCollisionInColumn(int x, int top, int bottom) const
+{
+    // Right edges of blocks only lie on the last pixel column of a tile
+    int localX = x - getX();
+    return localX % Level::TILE_SIZE == Level::TILE_SIZE - 1 && anyTileInColumn(x, top, bottom, Block::TILE_RIGHT_EDGE);
 }
 
 bool Layer::hasSlopeCollision(int x, int y) const
 {
-    auto block = getBlockAt(x, y);
-    if (block == nullptr)
+    if (!hasTileFlagAt(x, y, Block::TILE_SLOPE))
     {
         return false;
     }
@@ -175,41 +359,100 @@ bool Layer::hasSlopeCollision(int x, int y) const
     y -= getY();
 
     // Translate to block coordinates
-    return block->hasSlopeCollision(x - block->getX(), y - block->getY());
+    int tileX = x / Level::TILE_SIZE;
+    int tileY = y / Level::TILE_SIZE;
+    TileOffset offset = getTileOffset(tileX, tileY);
+    return getTile(tileX, tileY)->hasSlopeCollision(
+        offset.x * Level::TILE_SIZE + x % Level::TILE_SIZE,
+        offset.y * Level::TILE_SIZE + y % Level::TILE_SIZE
+    );
 }
 
-bool Layer::hasTopCollision(int x, int y) const
+bool Layer::hasSlopeInRectangle(int left, int top, int right, int bottom) const
 {
-    auto block = getBlockAt(x, y);
-    if (block == nullptr)
+    // Convert to local tile coordinates and clip to the layer
+    left -= getX();
+    right -= getX();
+    top -= getY();
+    bottom -= getY();
+    if (right < 0 || bottom < 0 || left >= width * Level::TILE_SIZE || top >= height * Level::TILE_SIZE)
     {
         return false;
     }
+    int tileLeft = std::max(left, 0) / Level::TILE_SIZE;
+    int tileRight = std::min(right, width * Level::TILE_SIZE - 1) / Level::TILE_SIZE;
+    int tileTop = std::max(top, 0) / Level::TILE_SIZE;
+    int tileBottom = std::min(bottom, height * Level::TILE_SIZE - 1) / Level::TILE_SIZE;
 
-    // Translate to local coordinates
+    for (int tileY = tileTop; tileY <= tileBottom; tileY++)
+    {
+        for (int tileX = tileLeft; tileX <= tileRight; tileX++)
+        {
+            if (getTileFlags(tileX, tileY) & Block::TILE_SLOPE)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Layer::hasTileFlagAt(int x, int y, uint8_t flag) const
+{
+    // Convert to local tile coordinates
     x -= getX();
     y -= getY();
+    if (x < 0 || y < 0 || x >= width * Level::TILE_SIZE || y >= height * Level::TILE_SIZE)
+    {
+        return false;
+    }
+    return (getTileFlags(x / Level::TILE_SIZE, y / Level::TILE_SIZE) & flag) != 0;
+}
 
-    // Translate to block coordinates
-    return block->hasTopCollision(x - block->getX(), y - block->getY());
+bool Layer::hasTopCollision(int x, int y) const
+{
+    // Top edges of blocks only lie on the first pixel row of a tile
+    return (y - getY()) % Level::TILE_SIZE == 0 && hasTileFlagAt(x, y, Block::TILE_TOP_EDGE);
 }
 
-void Layer::setVelocityX(float vx)
+bool Layer::hasTopCollisionInRow(int left, int right, int y) const
+{
+    // Top edges of blocks only lie on the first pixel row of a tile
+    int localY = y - getY();
+    return localY % Level::TILE_SIZE == 0 && anyTileInRow(left, right, y, Block::TILE_TOP_EDGE);
+}
+
+bool Layer::isWaterAt(int x, int y) const
+{
+    return hasTileFlagAt(x, y, Block::TILE_WATER);
+}
+
+void Layer::setVelocityX(Fixed vx)
 {
     velocityX = vx;
 }
 
-void Layer::setVelocityY(float vy)
+void Layer::setVelocityY(Fixed vy)
 {
     velocityY = vy;
 }
 
-void Layer::setX(float x)
+void Layer::setX(Fixed x)
 {
     positionX = x;
+    previousPositionX = x;
+    if (level != nullptr)
+    {
+        level->refitLayer(*this);
+    }
 }
 
-void Layer::setY(float y)
+void Layer::setY(Fixed y)
 {
     positionY = y;
+    previousPositionY = y;
+    if (level != nullptr)
+    {
+        level->refitLayer(*this);
+    }
 }
@@ -1,9 +1,14 @@
 #ifndef LAYER_HPP
 #define LAYER_HPP
 
+#include <cstdint>
 #include <vector>
 
+#include "../util/Fixed.hpp"
+
+class Arena;
 class Block;
+class Level;
 
 /**
  * A grid of Blocks in a Level.
@@ -11,38 +16,132 @@ class Block;
 class Layer
 {
     friend class Level;
+    friend class LevelFile;
 public:
+    /**
+     * The width and height of the chunks that the layer's tiles are stored in,
+     * in tiles, as a power of two.
+     */
+    static constexpr int CHUNK_SHIFT = 5;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+
+    /**
+     * The largest width or height of a block that can be added, in tiles.
+     */
+    static constexpr int MAX_BLOCK_SIZE = 1 << 16;
+
     /**
      * Create a new layer.
      *
      * @param width the width of the layer, int tiles.
      * @param height the height of the layer, in tiles.
+     * @param arena the arena to allocate tile chunks from, or nullptr to
+     * allocate them on the heap. The arena must outlive the layer.
      */
-    Layer(int width, int height);
+    Layer(int width, int height, Arena* arena = nullptr);
 
     ~Layer();
 
     /**
-     * Add a block to the layer.
+     * Place a block in the layer.
+     *
+     * The layer does not take ownership of the block, which must outlive it;
+     * blocks are usually shared definitions from Block::get().
+     *
+     * Tiles of the block that fall outside the layer are dropped, and a block
+     * entirely outside it is ignored. A block placed over others replaces
+     * them in the tiles it covers.
      *
      * @param x the left position of the block, in tiles.
      * @param y the top position of the block, in tiles.
-     * @param block the Block to add.
+     * @param block the Block to place, at most MAX_BLOCK_SIZE tiles wide and high.
      */
-    void addBlock(int x, int y, Block* block);
+    void addBlock(int x, int y, const Block* block);
 
     /**
      * Get a block located at a tile position.
      */
-    Block* getBlock(int x, int y);
     const Block* getBlock(int x, int y) const;
 
     /**
      * Get a block located at a pixel position, taking into account the layer's position.
      */
-    Block* getBlockAt(int x, int y);
     const Block* getBlockAt(int x, int y) const;
 
+    /**
+     * Get the bottom y coordinate of the layer's bounding box, in pixels.
+     */
+    int getBottom() const;
+
+    /**
+     * Get the distance upward from a horizontal span to the first row that causes a collision from the bottom.
+     *
+     * @param left the left x coordinate of the span, in pixels.
+     * @param right the right x coordinate of the span (inclusive), in pixels.
+     * @param y the y coordinate to start sweeping from, in pixels.
+     * @param maxDistance the maximum distance to sweep, in pixels.
+     * @return the distance in pixels, or maxDistance if there is no collision.
+     */
+    int getBottomCollisionDistance(int left, int right, int y, int maxDistance) const;
+
+    /**
+     * Get the left x coordinate of the layer's bounding box, in pixels.
+     */
+    int getLeft() const;
+
+    /**
+     * Get the distance rightward from a vertical span to the first column that causes a collision from the left.
+     *
+     * @param x the x coordinate to start sweeping from, in pixels.
+     * @param top the top y coordinate of the span, in pixels.
+     * @param bottom the bottom y coordinate of the span (inclusive), in pixels.
+     * @param maxDistance the maximum distance to sweep, in pixels.
+     * @return the distance in pixels, or maxDistance if there is no collision.
+     */
+    int getLeftCollisionDistance(int x, int top, int bottom, int maxDistance) const;
+
+    /**
+     * Get the right x coordinate of the layer's bounding box, in pixels.
+     */
+    int getRight() const;
+
+    /**
+     * Get the distance leftward from a vertical span to the first column that causes a collision from the right.
+     *
+     * @param x the x coordinate to start sweeping from, in pixels.
+     * @param top the top y coordinate of the span, in pixels.
+     * @param bottom the bottom y coordinate of the span (inclusive), in pixels.
+     * @param maxDistance the maximum distance to sweep, in pixels.
+     * @return the distance in pixels, or maxDistance if there is no collision.
+     */
+    int getRightCollisionDistance(int x, int top, int bottom, int maxDistance) const;
+
+    /**
+     * Get the distance downward from a pixel to the first pixel that causes a slope collision.
+     *
+     * @param x the x coordinate, in pixels.
+     * @param y the y coordinate to start sweeping from, in pixels.
+     * @param maxDistance the maximum distance to sweep, in pixels.
+     * @return the distance in pixels, or maxDistance if there is no collision.
+     */
+    int getSlopeCollisionDistance(int x, int y, int maxDistance) const;
+
+    /**
+     * Get the top y coordinate of the layer's bounding box, in pixels.
+     */
+    int getTop() const;
+
+    /**
+     * Get the distance downward from a horizontal span to the first row that causes a collision from the top.
+     *
+     * @param left the left x coordinate of the span, in pixels.
+     * @param right the right x coordinate of the span (inclusive), in pixels.
+     * @param y the y coordinate to start sweeping from, in pixels.
+     * @param maxDistance the maximum distance to sweep, in pixels.
+     * @return the distance in pixels, or maxDistance if there is no collision.
+     */
+    int getTopCollisionDistance(int left, int right, int y, int maxDistance) const;
+
     /**
      * Get the x position of the layer, in pixels.
      */
@@ -58,54 +157,172 @@ public:
      */
     bool hasBottomCollision(int x, int y) const;
 
+    /**
+     * Check if the layer causes a collision from the bottom at any pixel in a horizontal span.
+     *
+     * @param left the left x coordinate of the span, in pixels.
+     * @param right the right x coordinate of the span (inclusive), in pixels.
+     * @param y the y coordinate of the span, in pixels.
+     */
+    bool hasBottomCollisionInRow(int left, int right, int y) const;
+
     /**
      * Check if the layer causes a collision from the left at a particular pixel.
      */
     bool hasLeftCollision(int x, int y) const;
 
+    /**
+     * Check if the layer causes a collision from the left at any pixel in a vertical span.
+     *
+     * @param x the x coordinate of the span, in pixels.
+     * @param top the top y coordinate of the span, in pixels.
+     * @param bottom the bottom y coordinate of the span (inclusive), in pixels.
+     */
+    bool hasLeftCollisionInColumn(int x, int top, int bottom) const;
+
     /**
      * Check if the layer causes a collision from the right at a particular pixel.
      */
     bool hasRightCollision(int x, int y) const;
 
+    /**
+     * Check if the layer causes a collision from the right at any pixel in a vertical span.
+     *
+     * @param x the x coordinate of the span, in pixels.
+     * @param top the top y coordinate of the span, in pixels.
+     * @param bottom the bottom y coordinate of the span (inclusive), in pixels.
+     */
+    bool hasRightCollisionInColumn(int x, int top, int bottom) const;
+
     /**
      * Check if the layer has a top collision from a slope tile.
      */
     bool hasSlopeCollision(int x, int y) const;
 
+    /**
+     * Check if any slope block overlaps a rectangle, in pixels (inclusive).
+     */
+    bool hasSlopeInRectangle(int left, int top, int right, int bottom) const;
+
     /**
      * Check if the layer causes a collision from the top at a particular pixel.
      */
     bool hasTopCollision(int x, int y) const;
 
+    /**
+     * Check if the layer causes a collision from the top at any pixel in a horizontal span.
+     *
+     * @param left the left x coordinate of the span, in pixels.
+     * @param right the right x coordinate of the span (inclusive), in pixels.
+     * @param y the y coordinate of the span, in pixels.
+     */
+    bool hasTopCollisionInRow(int left, int right, int y) const;
+
+    /**
+     * Check if the layer has water at a particular pixel.
+     */
+    bool isWaterAt(int x, int y) const;
+
     /**
      * Set the x velocity of the layer.
      */
-    void setVelocityX(float vx);
+    void setVelocityX(Fixed vx);
 
     /**
      * Set the y velocity of the layer.
      */
-    void setVelocityY(float vy);
+    void setVelocityY(Fixed vy);
 
     /**
-     * Set the x position of the layer.
+     * Set the x position of the layer, without interpolating from the old one.
      */
-    void setX(float x);
+    void setX(Fixed x);
 
     /**
-     * set the y position of the layer.
+     * Set the y position of the layer, without interpolating from the old one.
      */
-    void setY(float y);
+    void setY(Fixed y);
 
 private:
+    /**
+     * Position of a tile within the block placed over it, in tiles.
+     */
+    struct TileOffset
+    {
+        uint16_t x;
+        uint16_t y;
+    };
+
+    /**
+     * A block placed in the layer.
+     */
+    struct Placement
+    {
+        int x; /**< Left position, in tiles. */
+        int y; /**< Top position, in tiles. */
+        const Block* block;
+    };
+
+    /**
+     * A square of tiles, indexed by row * CHUNK_SIZE + column.
+     */
+    struct Chunk
+    {
+        uint8_t flags[CHUNK_SIZE * CHUNK_SIZE]; /**< Block::TileFlag bits of each tile, read by collision queries. */
+        TileOffset offsets[CHUNK_SIZE * CHUNK_SIZE]; /**< Position of each tile within its block. */
+        const Block* blocks[CHUNK_SIZE * CHUNK_SIZE]; /**< Block placed over each tile, or nullptr. */
+    };
+
     int width;  /**< Width, in tiles. */
     int height; /**< Height, in tiles. */
-    float positionX; /**< X position, in pixels. */
-    float positionY; /**< Y position, in pixels. */
-    float velocityX; /**< X velocity, in pixels/frame. */
-    float velocityY; /**< Y velocity, in pixels/frame. */
-    std::vector<Block*> blocks;
+    Fixed positionX; /**< X position, in pixels. */
+    Fixed positionY; /**< Y position, in pixels. */
+    Fixed previousPositionX; /**< X position before the last update, in pixels. */
+    Fixed previousPositionY; /**< Y position before the last update, in pixels. */
+    Fixed velocityX; /**< X velocity, in pixels/frame. */
+    Fixed velocityY; /**< Y velocity, in pixels/frame. */
+    unsigned revision; /**< Incremented whenever blocks are added. */
+    unsigned long long changeRevision; /**< Level layer revision at which the layer was last added, moved or had blocks added. */
+    Arena* arena; /**< Arena that tile chunks are allocated from, or nullptr. */
+    Level* level; /**< Level that the layer has been added to, or nullptr. */
+    int chunksWide; /**< Number of chunks across the layer. */
+    std::vector<Chunk*> chunks; /**< Tile chunks in row-major order, allocated when a block is first added. */
+    std::vector<Placement> placements; /**< Blocks added to the layer, in the order they were added. */
+
+    /**
+     * Shared by all chunks that have no blocks. Never written to.
+     */
+    static Chunk emptyChunk;
+
+    /**
+     * Check if any tile under a vertical span of pixels has a Block::TileFlag.
+     */
+    bool anyTileInColumn(int x, int top, int bottom, uint8_t flag) const;
+
+    /**
+     * Check if any tile under a horizontal span of pixels has a Block::TileFlag.
+     */
+    bool anyTileInRow(int left, int right, int y, uint8_t flag) const;
+
+    /**
+     * Get the block at a tile position inside the layer, without bounds checking.
+     */
+    const Block* getTile(int x, int y) const;
+
+    /**
+     * Get the Block::TileFlag bits at a tile position inside the layer, without bounds checking.
+     */
+    uint8_t getTileFlags(int x, int y) const;
+
+    /**
+     * Get the position of a tile inside the layer within its block, without bounds checking.
+     */
+    TileOffset getTileOffset(int x, int y) const;
+
+    /**
+     * Check if the tile under a pixel has a Block::TileFlag.
+     */
+    bool hasTileFlagAt(int x, int y, uint8_t flag) const;
 };
 
 #endif // LAYER_HPP
@@ -0,0 +1,162 @@
+#include <algorithm>
+
+#include "LayerTree.hpp"
+
+void LayerTree::build(const std::vector<Layer*>& layers)
+{
+    this->layers = layers;
+    nodes.clear();
+    leaves.clear();
+    if (layers.empty())
+    {
+        return;
+    }
+
+    std::vector<int> layerIndices;
+    for (int i = 0; i < static_cast<int>(layers.size()); i++)
+    {
+        layerIndices.push_back(i);
+    }
+    nodes.reserve(2 * layers.size() - 1);
+    buildNode(layerIndices, 0, layerIndices.size(), -1);
+}
+
+int LayerTree::buildNode(std::vector<int>& layerIndices, int begin, int end, int parent)
+{
+    int index = nodes.size();
+    nodes.push_back(Node());
+    nodes[index].parent = parent;
+    nodes[index].children[0] = -1;
+    nodes[index].children[1] = -1;
+    nodes[index].layer = -1;
+
+    if (end - begin == 1)
+    {
+        nodes[index].layer = layerIndices[begin];
+        leaves[layers[layerIndices[begin]]] = index;
+        refitNode(index);
+        return index;
+    }
+
+    // Split the layers at the median center along the longest axis
+    // (centers are kept doubled to stay in integers)
+    int minX = layers[layerIndices[begin]]->getLeft() + layers[layerIndices[begin]]->getRight();
+    int maxX = minX;
+    int minY = layers[layerIndices[begin]]->getTop() + layers[layerIndices[begin]]->getBottom();
+    int maxY = minY;
+    for (int i = begin; i < end; i++)
+    {
+        const Layer* layer = layers[layerIndices[i]];
+        minX = std::min(minX, layer->getLeft() + layer->getRight());
+        maxX = std::max(maxX, layer->getLeft() + layer->getRight());
+        minY = std::min(minY, layer->getTop() + layer->getBottom());
+        maxY = std::max(maxY, layer->getTop() + layer->getBottom());
+    }
+    bool splitX = (maxX - minX >= maxY - minY);
+    int middle = (begin + end) / 2;
+    std::nth_element(
+        layerIndices.begin() + begin,
+        layerIndices.begin() + middle,
+        layerIndices.begin() + end,
+        [&](int a, int b) {
+            const Layer* layerA = layers[a];
+            const Layer* layerB = layers[b];
+            if (splitX)
+            {
+                return layerA->getLeft() + layerA->getRight() < layerB->getLeft() + layerB->getRight();
+            }
+            return layerA->getTop() + layerA->getBottom() < layerB->getTop() + layerB->getBottom();
+        }
+    );
+
+    int leftChild = buildNode(layerIndices, begin, middle, index);
+    int rightChild = buildNode(layerIndices, middle, end, index);
+    nodes[index].children[0] = leftChild;
+    nodes[index].children[1] = rightChild;
+    refitNode(index);
+    return index;
+}
+
+int LayerTree::getBottom() const
+{
+    return nodes.empty() ? 0 : nodes[0].bottom;
+}
+
+void LayerTree::getLayers(int left, int top, int right, int bottom, std::vector<int>& layerIndices) const
+{
+    layerIndices.clear();
+    traverse(left, top, right, bottom, [&](int layerIndex) {
+        layerIndices.push_back(layerIndex);
+        return false;
+    });
+
+    // Restore the original layer order
+    std::sort(layerIndices.begin(), layerIndices.end());
+}
+
+int LayerTree::getLeft() const
+{
+    return nodes.empty() ? 0 : nodes[0].left;
+}
+
+int LayerTree::getRight() const
+{
+    return nodes.empty() ? 0 : nodes[0].right;
+}
+
+int LayerTree::getTop() const
+{
+    return nodes.empty() ? 0 : nodes[0].top;
+}
+
+bool LayerTree::refit(const Layer& layer)
+{
+    auto leaf = leaves.find(&layer);
+    if (leaf == leaves.end())
+    {
+        return false;
+    }
+
+    // Parents only need refitting if their child changed
+    int index = leaf->second;
+    if (!refitNode(index))
+    {
+        return false;
+    }
+    index = nodes[index].parent;
+    while (index >= 0 && refitNode(index))
+    {
+        index = nodes[index].parent;
+    }
+    return true;
+}
+
+bool LayerTree::refitNode(int index)
+{
+    Node& node = nodes[index];
+    int left, top, right, bottom;
+    if (node.layer >= 0)
+    {
+        const Layer* layer = layers[node.layer];
+        left = layer->getLeft();
+        top = layer->getTop();
+        right = layer->getRight();
+        bottom = layer->getBottom();
+    }
+    else
+    {
+        const Node& a = nodes[node.children[0]];
+        const Node& b = nodes[node.children[1]];
+        left = std::min(a.left, b.left);
+        top = std::min(a.top, b.top);
+        right = std::max(a.right, b.right);
+        bottom = std::max(a.bottom, b.bottom);
+    }
+
+    bool changed = (left != node.left || top != node.top || right != node.right || bottom != node.bottom);
+    node.left = left;
+    node.top = top;
+    node.right = right;
+    node.bottom = bottom;
+    return changed;
+}
@@ -0,0 +1,164 @@
+#ifndef LAYERTREE_HPP
+#define LAYERTREE_HPP
+
+#include <unordered_map>
+#include <vector>
+
+#include "Layer.hpp"
+
+/**
+ * A bounding volume hierarchy over the Layers of a Level, used to find the
+ * layers near an area without scanning all of them.
+ *
+ * The tree is built once from the layers and refit as they move.
+ */
+class LayerTree
+{
+public:
+    /**
+     * Rebuild the tree from a list of layers.
+     *
+     * @param layers the layers, in the order that ordered queries report them.
+     */
+    void build(const std::vector<Layer*>& layers);
+
+    /**
+     * Find a layer overlapping a rectangle that satisfies a predicate.
+     *
+     * Layers are not visited in any particular order.
+     *
+     * @return the layer, or nullptr if none satisfies the predicate.
+     */
+    template <typename Predicate>
+    Layer* findLayer(int left, int top, int right, int bottom, Predicate predicate) const;
+
+    /**
+     * Call a function for every layer overlapping a rectangle.
+     *
+     * Layers are not visited in any particular order.
+     */
+    template <typename Function>
+    void forEachLayer(int left, int top, int right, int bottom, Function function) const;
+
+    /**
+     * Get the bottom edge of the bounds of all layers, or 0 if there are none.
+     */
+    int getBottom() const;
+
+    /**
+     * Get all layers overlapping a rectangle, in the order they were given to build().
+     *
+     * @param layerIndices the list to replace with the indices of the layers
+     * in the list given to build(), in increasing order.
+     */
+    void getLayers(int left, int top, int right, int bottom, std::vector<int>& layerIndices) const;
+
+    /**
+     * Get the left edge of the bounds of all layers, or 0 if there are none.
+     */
+    int getLeft() const;
+
+    /**
+     * Get the right edge of the bounds of all layers, or 0 if there are none.
+     */
+    int getRight() const;
+
+    /**
+     * Get the top edge of the bounds of all layers, or 0 if there are none.
+     */
+    int getTop() const;
+
+    /**
+     * Update the bounds of a layer after it moved.
+     *
+     * @return true if the bounds of the layer changed.
+     */
+    bool refit(const Layer& layer);
+
+private:
+    struct Node
+    {
+        int left;
+        int top;
+        int right;
+        int bottom;
+        int parent;
+        int children[2]; /**< Child nodes, or -1 for leaves. */
+        int layer;       /**< Index of the layer for leaves, -1 otherwise. */
+    };
+
+    /**
+     * Maximum tree depth supported by queries (the tree is balanced).
+     */
+    static constexpr int MAX_DEPTH = 64;
+
+    std::vector<Node> nodes;
+    std::vector<Layer*> layers;
+    std::unordered_map<const Layer*, int> leaves; /**< Leaf node of each layer. */
+
+    int buildNode(std::vector<int>& layerIndices, int begin, int end, int parent);
+
+    /**
+     * Update the bounds of a node from its layer or children.
+     *
+     * @return true if the bounds changed.
+     */
+    bool refitNode(int index);
+
+    /**
+     * Visit the indices of the layers whose bounds overlap a rectangle until the visitor returns true.
+     */
+    template <typename Visitor>
+    Layer* traverse(int left, int top, int right, int bottom, Visitor visitor) const;
+};
+
+template <typename Predicate>
+Layer* LayerTree::findLayer(int left, int top, int right, int bottom, Predicate predicate) const
+{
+    return traverse(left, top, right, bottom, [&](int layerIndex) {
+        return predicate(*layers[layerIndex]);
+    });
+}
+
+template <typename Function>
+void LayerTree::forEachLayer(int left, int top, int right, int bottom, Function function) const
+{
+    traverse(left, top, right, bottom, [&](int layerIndex) {
+        function(*layers[layerIndex]);
+        return false;
+    });
+}
+
+template <typename Visitor>
+Layer* LayerTree::traverse(int left, int top, int right, int bottom, Visitor visitor) const
+{
+    if (nodes.empty())
+    {
+        return nullptr;
+    }
+
+    int stack[MAX_DEPTH];
+    int size = 0;
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        const Node& node = nodes[stack[--size]];
+        if (node.left > right || node.right < left || node.top > bottom || node.bottom < top)
+        {
+            continue;
+        }
+        if (node.layer >= 0)
+        {
+            if (visitor(node.layer))
+            {
+                return layers[node.layer];
+            }
+            continue;
+        }
+        stack[size++] = node.children[0];
+        stack[size++] = node.children[1];
+    }
+    return nullptr;
+}
+
+#endif // LAYERTREE_HPP
@@ -1,6 +1,8 @@
-#include <cmath>
-#include <set>
+#include <algorithm>
+#include <cstdlib>
 
+#include "../util/LatencyTracker.hpp"
+#include "../util/Profiler.hpp"
 #include "../video/VideoManager.hpp"
 
 #include "Block.hpp"
@@ -8,158 +10,315 @@
 #include "Layer.hpp"
 #include "Level.hpp"
 
-Level::Level()
+Level::Level() :
+    layerTreeDirty(false),
+    layerRevision(1),
+    entityRenderMargin(0),
+    updatingEntities(false)
 {
 }
 
 Level::~Level()
 {
-    // Free all layers
-    for (auto layer : layers)
-    {
-        delete layer;
-    }
+    // Layers and entities are freed along with the arena
+}
 
-    // Free all entities
-    for (auto entity : entities)
-    {
-        delete entity;
+void Level::addBlockGeometry(Geometry& geometry, const Block& block, int x, int y) const
+{
+    static constexpr unsigned BLOCK_COLOR = 0x00ff00;
+    static constexpr unsigned WATER_COLOR = 0x0000ff;
+
+    switch (block.collisionType)
+    {
+    case Block::CollisionType::SLOPE_LEFT:
+        geometry.addLine(
+            x + block.getWidth(), y + block.getHeight(),
+            x, y,
+            BLOCK_COLOR
+        );
+        break;
+    case Block::CollisionType::SLOPE_RIGHT:
+        geometry.addLine(
+            x, y + block.getHeight(),
+            x + block.getWidth(), y,
+            BLOCK_COLOR
+        );
+        break;
+    case Block::CollisionType::SOLID:
+        geometry.addRectangle(x, y, block.getWidth(), block.getHeight(), BLOCK_COLOR);
+        break;
+    case Block::CollisionType::PLATFORM:
+        geometry.addLine(x, y, x + block.getWidth(), y, BLOCK_COLOR);
+        break;
+    case Block::CollisionType::WATER:
+        geometry.addRectangle(x, y, block.getWidth(), block.getHeight(), WATER_COLOR);
+        break;
+
+    default:
+        break;
     }
 }
 
 void Level::addEntity(Entity* entity)
 {
     entity->level = this;
-    entities.push_back(entity);
+    entity->contactRevision = 0;
+    entity->contactLayerCount = -1;
+    entityStore.add(entity);
+    entityGrid.insert(entity);
 }
 
 void Level::addLayer(Layer* layer)
 {
+    layer->level = this;
+    markLayerChanged(*layer);
     layers.push_back(layer);
+    layerGeometry.push_back({0, 0, {}});
+    layerTreeDirty = true;
 }
 
-bool Level::canEntityMoveDown(Entity& entity) const
+void Level::buildLayerGeometry(const Layer& layer, LayerGeometry& geometry) const
 {
-    // Check for blocks below
-    for (auto layer : layers)
+    static constexpr int CHUNK_PIXEL_WIDTH = GEOMETRY_CHUNK_WIDTH * TILE_SIZE;
+
+    geometry.chunks.resize((layer.width + GEOMETRY_CHUNK_WIDTH - 1) / GEOMETRY_CHUNK_WIDTH);
+    for (auto& chunk : geometry.chunks)
     {
-        if (layer->hasSlopeCollision(entity.getCenterX(), entity.getBottom() + 1))
-        {
-            return false;
-        }
-        // TODO: does this have to be every x coordinate?
-        for (int x = 0; x < entity.width; x++)
+        chunk.clear();
+    }
+
+    // Add every placed block, including ones that later blocks were placed
+    // partly over, to the column of its first tile in the layer. Blocks are
+    // added in the order they were placed, so later ones are drawn on top.
+    for (const Layer::Placement& placement : layer.placements)
+    {
+        int column = std::max(placement.x, 0) / GEOMETRY_CHUNK_WIDTH;
+        addBlockGeometry(geometry.chunks[column], *placement.block, placement.x * TILE_SIZE, placement.y * TILE_SIZE);
+    }
+
+    geometry.overhang = 0;
+    for (int i = 0; i < static_cast<int>(geometry.chunks.size()); i++)
+    {
+        if (!geometry.chunks[i].isEmpty())
         {
-            if (layer->hasTopCollision(entity.getLeft() + x, entity.getBottom() + 1))
-            {
-                return false;
-            }
+            geometry.overhang = std::max(geometry.overhang, geometry.chunks[i].getRight() - ((i + 1) * CHUNK_PIXEL_WIDTH - 1));
         }
     }
-    return true;
+    geometry.revision = layer.revision;
+}
+
+bool Level::canEntityMoveDown(Entity& entity) const
+{
+    // Check for blocks below
+    int y = entity.getBottom() + 1;
+    return getLayerTree().findLayer(entity.getLeft(), y, entity.getRight(), y, [&](const Layer& layer) {
+        return layer.hasSlopeCollision(entity.getCenterX(), y) ||
+               layer.hasTopCollisionInRow(entity.getLeft(), entity.getRight(), y);
+    }) == nullptr;
 }
 
 bool Level::canEntityMoveLeft(Entity& entity) const
 {
     // Check for blocks to the left
-    for (auto layer : layers)
-    {
-        // TODO: this doesn't have to be every single y coordinate. Just once every 16 pixels
-        for (int y = 0; y < entity.height; y++)
-        {
-            if (layer->hasRightCollision(entity.getLeft() - 1, entity.getTop() + y))
-            {
-                return false;
-            }
-        }
-    }
-
-    return true;
+    int x = entity.getLeft() - 1;
+    return getLayerTree().findLayer(x, entity.getTop(), x, entity.getBottom(), [&](const Layer& layer) {
+        return layer.hasRightCollisionInColumn(x, entity.getTop(), entity.getBottom());
+    }) == nullptr;
 }
 
 bool Level::canEntityMoveRight(Entity& entity) const
 {
     // Check for blocks to the right
-    for (auto layer : layers)
-    {
-        // TODO: this doesn't have to be every single y coordinate. Just once every 16 pixels
-        for (int y = 0; y < entity.height; y++)
-        {
-            if (layer->hasLeftCollision(entity.getRight() + 1, entity.getTop() + y))
-            {
-                return false;
-            }
-        }
-    }
-
-    return true;
+    int x = entity.getRight() + 1;
+    return getLayerTree().findLayer(x, entity.getTop(), x, entity.getBottom(), [&](const Layer& layer) {
+        return layer.hasLeftCollisionInColumn(x, entity.getTop(), entity.getBottom());
+    }) == nullptr;
 }
 
 bool Level::canEntityMoveUp(Entity& entity) const
 {
     // Check for blocks above
-    for (auto layer : layers)
+    int y = entity.getTop() - 1;
+    return getLayerTree().findLayer(entity.getLeft(), y, entity.getRight(), y, [&](const Layer& layer) {
+        return layer.hasBottomCollisionInRow(entity.getLeft(), entity.getRight(), y);
+    }) == nullptr;
+}
+
+Layer* Level::createLayer(int width, int height)
+{
+    return arena.create<Layer>(width, height, &arena);
+}
+
+void Level::findEntitiesNearLayer(const Layer& layer)
+{
+    // Entities interact with a moving layer when they are within a pixel of
+    // its edges, and the layer itself moves a pixel, so leave some margin
+    static constexpr int MARGIN = 2;
+
+    nearbyEntities.clear();
+    entityGrid.query(
+        layer.getLeft() - MARGIN,
+        layer.getTop() - MARGIN,
+        layer.getRight() + MARGIN,
+        layer.getBottom() + MARGIN,
+        nearbyEntities
+    );
+}
+
+const Layer* Level::findGroundLayer(const Entity& entity) const
+{
+    int y = entity.getBottom() + 1;
+    return getLayerTree().findLayer(entity.getLeft(), y, entity.getRight(), y, [&](const Layer& layer) {
+        return isEntityStandingOnLayer(layer, entity);
+    });
+}
+
+int Level::getBottom() const
+{
+    return getLayerTree().getBottom();
+}
+
+int Level::getEntityClearanceDown(const Entity& entity, int maxDistance) const
+{
+    // Find the number of pixels the entity can move down before canEntityMoveDown() fails
+    int clearance = maxDistance;
+    int y = entity.getBottom() + 1;
+    getLayerTree().forEachLayer(entity.getLeft(), y, entity.getRight(), y + maxDistance - 1, [&](const Layer& layer) {
+        clearance = layer.getSlopeCollisionDistance(entity.getCenterX(), y, clearance);
+        clearance = layer.getTopCollisionDistance(entity.getLeft(), entity.getRight(), y, clearance);
+    });
+    return clearance;
+}
+
+int Level::getEntityClearanceLeft(const Entity& entity, int maxDistance) const
+{
+    // Find the number of pixels the entity can move left before canEntityMoveLeft() fails
+    int clearance = maxDistance;
+    int x = entity.getLeft() - 1;
+    getLayerTree().forEachLayer(x - maxDistance + 1, entity.getTop(), x, entity.getBottom(), [&](const Layer& layer) {
+        clearance = layer.getRightCollisionDistance(x, entity.getTop(), entity.getBottom(), clearance);
+    });
+    return clearance;
+}
+
+int Level::getEntityClearanceRight(const Entity& entity, int maxDistance) const
+{
+    // Find the number of pixels the entity can move right before canEntityMoveRight() fails
+    int clearance = maxDistance;
+    int x = entity.getRight() + 1;
+    getLayerTree().forEachLayer(x, entity.getTop(), x + maxDistance - 1, entity.getBottom(), [&](const Layer& layer) {
+        clearance = layer.getLeftCollisionDistance(x, entity.getTop(), entity.getBottom(), clearance);
+    });
+    return clearance;
+}
+
+int Level::getEntityClearanceUp(const Entity& entity, int maxDistance) const
+{
+    // Find the number of pixels the entity can move up before canEntityMoveUp() fails
+    int clearance = maxDistance;
+    int y = entity.getTop() - 1;
+    getLayerTree().forEachLayer(entity.getLeft(), y - maxDistance + 1, entity.getRight(), y, [&](const Layer& layer) {
+        clearance = layer.getBottomCollisionDistance(entity.getLeft(), entity.getRight(), y, clearance);
+    });
+    return clearance;
+}
+
+const LayerTree& Level::getLayerTree() const
+{
+    // Built on first use rather than in addLayer(), so that adding n layers
+    // builds the tree once instead of n times
+    if (layerTreeDirty)
     {
-        // TODO: does this have to be every x coordinate?
-        for (int x = 0; x < entity.width; x++)
-        {
-            if (layer->hasBottomCollision(entity.getLeft() + x, entity.getTop() - 1))
-            {
-                return false;
-            }
-        }
+        layerTree.build(layers);
+        layerTreeDirty = false;
     }
-    return true;
+    return layerTree;
 }
 
-bool Level::isEntityOnGround(const Entity& entity) const
+int Level::getLeft() const
 {
-    for (auto layer : layers)
+    return getLayerTree().getLeft();
+}
+
+int Level::getRight() const
+{
+    return getLayerTree().getRight();
+}
+
+uint64_t Level::getStateHash() const
+{
+    // FNV-1a over the raw values, so that equal states hash equally on any platform
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](int32_t value)
     {
-        if (isEntityStandingOnLayer(*layer, entity))
+        uint32_t bits = static_cast<uint32_t>(value);
+        for (int i = 0; i < 4; i++)
         {
-            return true;
+            hash = (hash ^ ((bits >> (i * 8)) & 0xff)) * 1099511628211ULL;
         }
+    };
+
+    for (const Layer* layer : layers)
+    {
+        add(layer->positionX.getRaw());
+        add(layer->positionY.getRaw());
+        add(layer->velocityX.getRaw());
+        add(layer->velocityY.getRaw());
     }
-    return false;
+    for (int i = 0; i < entityStore.size(); i++)
+    {
+        add(entityStore.positionX[i].getRaw());
+        add(entityStore.positionY[i].getRaw());
+        add(entityStore.velocityX[i].getRaw());
+        add(entityStore.velocityY[i].getRaw());
+    }
+    return hash;
+}
+
+int Level::getTop() const
+{
+    return getLayerTree().getTop();
 }
 
 bool Level::isEntityStandingOnLayer(const Layer& layer, const Entity& entity) const
 {
     // Check the bottom pixels of the entity's bounding box
-    // TODO: we can probably only check every 16 pixels/the center to save time here
     if (layer.hasSlopeCollision(entity.getCenterX(), entity.getBottom() + 1))
     {
         return true;
     }
-    for (int x = 0; x < entity.width; x++)
-    {
-        if (layer.hasTopCollision(entity.getLeft() + x, entity.getBottom() + 1))
-        {
-            return true;
-        }
-    }
-    return false;
+    return layer.hasTopCollisionInRow(entity.getLeft(), entity.getRight(), entity.getBottom() + 1);
+}
+
+bool Level::isSlopeNearEntity(const Entity& entity, int distance) const
+{
+    // Check the area that moveEntityX() inspects for slopes while moving the entity's center
+    int left = std::min(entity.getCenterX(), entity.getCenterX() + distance);
+    int right = std::max(entity.getCenterX(), entity.getCenterX() + distance);
+    int top = entity.getBottom();
+    int bottom = entity.getBottom() + 2;
+    return getLayerTree().findLayer(left, top, right, bottom, [&](const Layer& layer) {
+        return layer.hasSlopeInRectangle(left, top, right, bottom);
+    }) != nullptr;
 }
 
 bool Level::isUnderwaterAt(int x, int y) const
 {
-    for (auto layer : layers)
-    {
-        const Block* block = layer->getBlockAt(x, y);
-        if (block != nullptr && block->collisionType == Block::CollisionType::WATER)
-        {
-            return true;
-        }
-    }
-    return false;
+    return getLayerTree().findLayer(x, y, x, y, [&](const Layer& layer) {
+        return layer.isWaterAt(x, y);
+    }) != nullptr;
+}
+
+void Level::markLayerChanged(Layer& layer)
+{
+    layer.changeRevision = ++layerRevision;
 }
 
 bool Level::moveEntityDown(Entity& entity)
 {
     if (canEntityMoveDown(entity))
     {
-        moveEntityY(entity, 1.0f);
+        moveEntityY(entity, 1);
         return true;
     }
     return false;
@@ -169,7 +328,7 @@ bool Level::moveEntityLeft(Entity& entity)
 {
     if (canEntityMoveLeft(entity))
     {
-        moveEntityX(entity, -1.0f);
+        moveEntityX(entity, -1);
         return true;
     }
     return false;
@@ -179,7 +338,7 @@ bool Level::moveEntityRight(Entity& entity)
 {
     if (canEntityMoveRight(entity))
     {
-        moveEntityX(entity, 1.0f);
+        moveEntityX(entity, 1);
         return true;
     }
     return false;
@@ -189,13 +348,13 @@ bool Level::moveEntityUp(Entity& entity)
 {
     if (canEntityMoveUp(entity))
     {
-        moveEntityY(entity, -1.0f);
+        moveEntityY(entity, -1);
         return true;
     }
     return false;
 }
 
-void Level::moveEntityX(Entity& entity, float dx)
+void Level::moveEntityX(Entity& entity, Fixed dx)
 {
     int newCenterX;
     if (dx > 0)
@@ -207,9 +366,11 @@ void Level::moveEntityX(Entity& entity, float dx)
         newCenterX = entity.getCenterX() - 1;
     }
 
-    // Go up/down slopes
-    for (auto layer : layers)
+    // Go up/down slopes, checking layers in order
+    getLayerTree().getLayers(entity.getLeft() - 1, entity.getBottom(), entity.getRight() + 1, entity.getBottom() + 2, nearbyLayers);
+    for (auto layerIndex : nearbyLayers)
     {
+        Layer* layer = layers[layerIndex];
         // Are we standing on the layer with our center pixel?
         if (!isEntityStandingOnLayer(*layer, entity))
         {
@@ -220,7 +381,7 @@ void Level::moveEntityX(Entity& entity, float dx)
         // Go up slopes that we run into
         if (layer->hasSlopeCollision(newCenterX, entity.getBottom()))
         {
-            entity.positionX += dx;
+            entityStore.positionX[entity.index] += dx;
             moveEntityUp(entity);
             return;
         }
@@ -228,24 +389,25 @@ void Level::moveEntityX(Entity& entity, float dx)
         // Go down slopes that we run into
         if (layer->hasSlopeCollision(newCenterX, entity.getBottom() + 2))
         {
-            entity.positionX += dx;
-            moveEntityY(entity, 1.0f); // Intentional: forced sinking. This may become a bug.
+            entityStore.positionX[entity.index] += dx;
+            moveEntityY(entity, 1); // Intentional: forced sinking. This may become a bug.
             return;
         }
     }
 
-    entity.positionX += dx;
+    entityStore.positionX[entity.index] += dx;
 }
 
-void Level::moveEntityY(Entity& entity, float dy)
+void Level::moveEntityY(Entity& entity, Fixed dy)
 {
-    entity.positionY += dy;
+    entityStore.positionY[entity.index] += dy;
 }
 
 void Level::moveLayerDown(Layer& layer)
 {
     // Move any entities that are standing on this layer or colliding with the bottom edge of it
-    for (auto entity : entities)
+    findEntitiesNearLayer(layer);
+    for (auto entity : nearbyEntities)
     {
         if (isEntityStandingOnLayer(layer, *entity))
         {
@@ -253,365 +415,443 @@ void Level::moveLayerDown(Layer& layer)
             // to move the entity down (otherwise the layer will get in the way
             // of the entity's movement). So we temporarily adjust the layer's
             // position and change it back after we move the entity.
-            float positionY = layer.positionY++;
+            Fixed positionY = layer.positionY++;
+            refitLayer(layer);
             moveEntityDown(*entity);
             layer.positionY = positionY;
+            refitLayer(layer);
             continue;
         }
-        for (int x = 0; x < entity->width; x++)
+        if (layer.hasBottomCollisionInRow(entity->getLeft(), entity->getRight(), entity->getTop() - 1))
         {
-            if (layer.hasBottomCollision(entity->getLeft() + x, entity->getTop() - 1))
-            {
-                moveEntityDown(*entity);
-                break;
-            }
+            moveEntityDown(*entity);
         }
     }
     layer.positionY++;
+    refitLayer(layer);
+
+    for (auto entity : nearbyEntities)
+    {
+        entityGrid.update(entity);
+    }
 }
 
 void Level::moveLayerLeft(Layer& layer)
 {
     // Move any entities that are standing on this layer or colliding with the left edge of it
-    for (auto entity : entities)
+    findEntitiesNearLayer(layer);
+    for (auto entity : nearbyEntities)
     {
         if (isEntityStandingOnLayer(layer, *entity))
         {
             if (canEntityMoveLeft(*entity))
             {
                 // Simply move to the left (no need to handle slopes)
-                entity->positionX--;
+                entityStore.positionX[entity->index]--;
             }
             continue;
         }
-        for (int y = 0; y < entity->height; y++)
+        if (layer.hasLeftCollisionInColumn(entity->getRight() + 1, entity->getTop(), entity->getBottom()))
         {
-            if (layer.hasLeftCollision(entity->getRight() + 1, entity->getTop() + y))
-            {
-                moveEntityLeft(*entity);
-                break;
-            }
+            moveEntityLeft(*entity);
         }
     }
     layer.positionX--;
+    refitLayer(layer);
 
     // Catch any entities that got shoved into a slope (very rare)
     // Usually happens when an entity is on a slope that moves into another layer
-    for (auto entity : entities)
+    for (auto entity : nearbyEntities)
     {
         if (layer.hasSlopeCollision(entity->getCenterX(), entity->getBottom()))
         {
             moveEntityUp(*entity);
         }
+        entityGrid.update(entity);
     }
 }
 
 void Level::moveLayerRight(Layer& layer)
 {
     // Move any entities that are standing on this layer or colliding with the right edge of it
-    for (auto entity : entities)
+    findEntitiesNearLayer(layer);
+    for (auto entity : nearbyEntities)
     {
         if (isEntityStandingOnLayer(layer, *entity))
         {
             if (canEntityMoveRight(*entity))
             {
                 // Simply move to the right (no need to handle slopes)
-                entity->positionX++;
+                entityStore.positionX[entity->index]++;
             }
             continue;
         }
-        for (int y = 0; y < entity->height; y++)
+        if (layer.hasRightCollisionInColumn(entity->getLeft() - 1, entity->getTop(), entity->getBottom()))
         {
-            if (layer.hasRightCollision(entity->getLeft() - 1, entity->getTop() + y))
-            {
-                moveEntityRight(*entity);
-                break;
-            }
+            moveEntityRight(*entity);
         }
     }
     layer.positionX++;
+    refitLayer(layer);
 
     // Catch any entities that got shoved into a slope (very rare)
     // Usually happens when an entity is on a slope that moves into another layer
-    for (auto entity : entities)
+    for (auto entity : nearbyEntities)
     {
         if (layer.hasSlopeCollision(entity->getCenterX(), entity->getBottom()))
         {
             moveEntityUp(*entity);
         }
+        entityGrid.update(entity);
     }
 }
 
 void Level::moveLayerUp(Layer& layer)
 {
     // Move any entities that are standing on this layer
-    for (auto entity : entities)
+    findEntitiesNearLayer(layer);
+    for (auto entity : nearbyEntities)
     {
         if (isEntityStandingOnLayer(layer, *entity))
         {
             moveEntityUp(*entity);
+            entityGrid.update(entity);
         }
     }
     layer.positionY--;
+    refitLayer(layer);
 }
 
-void Level::render(VideoManager& video, int left, int right, int top, int bottom) const
+void Level::refitLayer(Layer& layer)
 {
-    // Render all blocks
-    for (auto layer : layers)
+    // A tree that hasn't been built yet picks up the position when it is
+    if (layerTreeDirty || layerTree.refit(layer))
+    {
+        markLayerChanged(layer);
+    }
+}
+
+void Level::removeEntity(Entity* entity)
+{
+    // Removing an entity moves the last one into its slot, which would make
+    // the update loop skip it, so wait until the loop is done
+    if (updatingEntities)
     {
-        std::set<Block*> blocks;
-        for (int x = left; x < right + TILE_SIZE; x += TILE_SIZE)
+        if (std::find(removedEntities.begin(), removedEntities.end(), entity) == removedEntities.end())
         {
-            for (int y = top; y < bottom + TILE_SIZE; y += TILE_SIZE)
-            {
-                auto block = layer->getBlockAt(x, y);
-                if (block != nullptr)
-                {
-                    blocks.insert(block);
-                }
-            }
+            removedEntities.push_back(entity);
+        }
+        return;
+    }
+
+    entityGrid.remove(entity);
+    entityStore.remove(entity);
+    entity->level = nullptr;
+}
+
+void Level::render(VideoManager& video, int left, int right, int top, int bottom, Fixed interpolation) const
+{
+    PROFILE_ZONE("Level::render");
+
+    // Render the geometry of the blocks near the camera
+    static constexpr int CHUNK_PIXEL_WIDTH = GEOMETRY_CHUNK_WIDTH * TILE_SIZE;
+    getLayerTree().getLayers(left, top, right + TILE_SIZE - 1, bottom + TILE_SIZE - 1, visibleLayers);
+    for (auto layerIndex : visibleLayers)
+    {
+        const Layer& layer = *layers[layerIndex];
+        LayerGeometry& geometry = layerGeometry[layerIndex];
+        if (geometry.revision != layer.revision)
+        {
+            buildLayerGeometry(layer, geometry);
         }
 
-        int xOffset = layer->getX() - left;
-        int yOffset = layer->getY() - top;
-        for (auto block : blocks)
+        int layerX = interpolate(layer.previousPositionX, layer.positionX, interpolation).floor();
+        int layerY = interpolate(layer.previousPositionY, layer.positionY, interpolation).floor();
+        int firstChunk = std::max((left - layerX - geometry.overhang) / CHUNK_PIXEL_WIDTH, 0);
+        int lastChunk = std::min((right - layerX) / CHUNK_PIXEL_WIDTH, static_cast<int>(geometry.chunks.size()) - 1);
+        for (int i = firstChunk; i <= lastChunk; i++)
         {
-            video.setColor(0x00ff00);
-            switch (block->collisionType)
+            const Geometry& chunk = geometry.chunks[i];
+            if (!chunk.isEmpty() &&
+                chunk.getLeft() + layerX <= right && chunk.getRight() + layerX >= left &&
+                chunk.getTop() + layerY <= bottom && chunk.getBottom() + layerY >= top)
             {
-            case Block::CollisionType::SLOPE_LEFT:
-                video.drawLine(
-                    block->getRight() + 1 + xOffset, block->getBottom() + 1 + yOffset,
-                    block->getLeft() + xOffset, block->getTop() + yOffset
-                );
-                break;
-            case Block::CollisionType::SLOPE_RIGHT:
-                video.drawLine(
-                    block->getLeft() + xOffset, block->getBottom() + 1 + yOffset,
-                    block->getRight() + 1 + xOffset, block->getTop() + yOffset
-                );
-                break;
-            case Block::CollisionType::SOLID:
-                video.drawRectangle(
-                    block->getX() + xOffset,
-                    block->getY() + yOffset,
-                    block->getWidth(),
-                    block->getHeight()
-                );
-                break;
-            case Block::CollisionType::PLATFORM:
-                video.drawLine(
-                    block->getLeft() + xOffset, block->getTop() + yOffset,
-                    block->getRight() + 1 + xOffset, block->getTop() + yOffset);
-                break;
-            case Block::CollisionType::WATER:
-                video.setColor(0x0000ff);
-                video.drawRectangle(
-                    block->getX() + xOffset,
-                    block->getY() + yOffset,
-                    block->getWidth(),
-                    block->getHeight()
-                );
-                break;
-
-            default:
-                break;
+                video.drawGeometry(chunk, layerX - left, layerY - top);
             }
         }
     }
 
-    // Render all entities
-    for (auto entity : entities)
+    // Render the entities near the camera, in the order they were added
+    visibleEntities.clear();
+    entityGrid.query(
+        left - entityRenderMargin,
+        top - entityRenderMargin,
+        right + entityRenderMargin,
+        bottom + entityRenderMargin,
+        visibleEntities
+    );
+    std::sort(visibleEntities.begin(), visibleEntities.end(), [](const Entity* a, const Entity* b) {
+        return a->index < b->index;
+    });
+    video.setColor(0xff0000);
+    for (auto entity : visibleEntities)
     {
-        video.setColor(0xff0000);
-        video.drawRectangle(entity->getX(), entity->getY(), entity->width, entity->height);
+        int i = entity->index;
+        int x = interpolate(entityStore.previousPositionX[i], entityStore.positionX[i], interpolation).floor();
+        int y = interpolate(entityStore.previousPositionY[i], entityStore.positionY[i], interpolation).floor();
+        if (x <= right && x + entityStore.width[i] > left && y <= bottom && y + entityStore.height[i] > top)
+        {
+            video.drawRectangle(x - left, y - top, entityStore.width[i], entityStore.height[i]);
+        }
     }
 }
 
 void Level::update()
 {
+    PROFILE_ZONE("Level::update");
+
+    // Entities and layers may have been moved since the last update
+    for (auto entity : entityStore.entities)
+    {
+        entityGrid.update(entity);
+    }
+    getLayerTree();
+    for (auto layer : layers)
+    {
+        refitLayer(*layer);
+    }
+
+    // Remember where everything was, for interpolating between updates
+    for (auto layer : layers)
+    {
+        layer->previousPositionX = layer->positionX;
+        layer->previousPositionY = layer->positionY;
+    }
+    entityStore.previousPositionX = entityStore.positionX;
+    entityStore.previousPositionY = entityStore.positionY;
+
     // Update all layers
     for (auto layer : layers)
     {
         updateLayer(*layer);
     }
 
-    // Update all entities
-    for (auto entity : entities)
+    // Update all entities. Entities don't affect each other, so each step is
+    // run over all of them before the next one, walking the arrays linearly.
+    int count = entityStore.size();
+    for (int i = 0; i < count; i++)
+    {
+        entityStore.velocityX[i] += entityStore.accelerationX[i];
+    }
+    for (int i = 0; i < count; i++)
+    {
+        updateEntityMotionX(*entityStore.entities[i]);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        entityStore.velocityY[i] += entityStore.accelerationY[i];
+    }
+    for (int i = 0; i < count; i++)
+    {
+        updateEntityMotionY(*entityStore.entities[i]);
+    }
+
+    // Entities have now moved in reaction to all input recorded so far
+    LATENCY_UPDATE();
+
+    updatingEntities = true;
+    for (int i = 0; i < count; i++)
+    {
+        entityStore.entities[i]->onUpdate();
+    }
+    updatingEntities = false;
+
+    for (auto entity : removedEntities)
     {
-        updateEntity(*entity);
+        removeEntity(entity);
     }
+    removedEntities.clear();
+
+    // The entity grid holds each entity at its position either before or
+    // after this update (setX() and setY() move both), and entities are
+    // rendered in between, so look as far around the camera as any entity
+    // moved
+    int64_t maxDistance = 0;
+    for (int i = 0; i < entityStore.size(); i++)
+    {
+        int64_t distanceX = static_cast<int64_t>(entityStore.positionX[i].getRaw()) - entityStore.previousPositionX[i].getRaw();
+        int64_t distanceY = static_cast<int64_t>(entityStore.positionY[i].getRaw()) - entityStore.previousPositionY[i].getRaw();
+        maxDistance = std::max(maxDistance, std::max(std::abs(distanceX), std::abs(distanceY)));
+    }
+    entityRenderMargin = static_cast<int>(maxDistance / Fixed::ONE) + 1;
 }
 
-void Level::updateEntity(Entity& entity)
+void Level::updateEntityContacts(const Entity& entity) const
 {
-    entity.velocityX += entity.accelerationX;
-    updateEntityMotionX(entity);
-    entity.velocityY += entity.accelerationY;
-    updateEntityMotionY(entity);
+    bool moved = entity.contactX != entity.getX() || entity.contactY != entity.getY();
+    if (!moved && entity.contactRevision == layerRevision)
+    {
+        return;
+    }
+    entity.contactRevision = layerRevision;
 
-    entity.onUpdate();
+    // The contacts only depend on the layers overlapping the entity or the
+    // row below it. They still hold if none of those has changed since, and
+    // none has moved in or out: a layer moving in would be the latest change,
+    // and one moving out would lower the count.
+    unsigned long long latestChange = 0;
+    int layerCount = 0;
+    getLayerTree().forEachLayer(entity.getLeft(), entity.getTop(), entity.getRight(), entity.getBottom() + 1, [&](const Layer& layer) {
+        latestChange = std::max(latestChange, layer.changeRevision);
+        layerCount++;
+    });
+    if (!moved && latestChange == entity.contactLayerRevision && layerCount == entity.contactLayerCount)
+    {
+        return;
+    }
+
+    entity.groundLayer = findGroundLayer(entity);
+    entity.underwater = isUnderwaterAt(entity.getCenterX(), entity.getCenterY());
+    entity.atSurfaceOfWater = entity.underwater && !isUnderwaterAt(entity.getCenterX(), entity.getTop());
+    entity.contactX = entity.getX();
+    entity.contactY = entity.getY();
+    entity.contactLayerRevision = latestChange;
+    entity.contactLayerCount = layerCount;
 }
 
 void Level::updateEntityMotionX(Entity& entity)
 {
-    // Move left/right one pixel at a time
-    float dx = entity.velocityX;
-    while (dx >= 1.0f)
+    Fixed& positionX = entityStore.positionX[entity.index];
+    Fixed& velocityX = entityStore.velocityX[entity.index];
+    Fixed dx = velocityX;
+    if (dx == 0)
     {
-        if (moveEntityRight(entity))
-        {
-            dx--;
-        }
-        else
+        return;
+    }
+    Fixed step = (dx > 0) ? 1 : -1;
+    int reach = abs(dx).floor() + 1;
+
+    // Sweep for the first wall once instead of checking every pixel. The entity
+    // can only move vertically here by walking on slopes, so only take the
+    // per-pixel slope path near them and sweep again whenever it moved us.
+    bool nearSlope = isSlopeNearEntity(entity, step.floor() * reach);
+    int sweptY = entity.getY();
+    int clearance = (step > 0) ? getEntityClearanceRight(entity, reach) : getEntityClearanceLeft(entity, reach);
+    auto canMove = [&]() {
+        if (entity.getY() != sweptY)
         {
-            entity.velocityX = 0.0f;
-            return;
+            sweptY = entity.getY();
+            clearance = (step > 0) ? getEntityClearanceRight(entity, reach) : getEntityClearanceLeft(entity, reach);
         }
-    }
-    if (dx > 0.0f)
-    {
-        if (std::floor(entity.positionX + dx) == std::floor(entity.positionX + 1))
+        return clearance > 0;
+    };
+    auto move = [&](Fixed distance) {
+        if (nearSlope)
         {
-            if (canEntityMoveRight(entity))
-            {
-                moveEntityX(entity, dx);
-            }
-            else
-            {
-                entity.velocityX = 0.0f;
-                return;
-            }
+            moveEntityX(entity, distance);
         }
         else
         {
-            entity.positionX += dx;
+            positionX += distance;
         }
-        return;
-    }
-    while (dx <= -1.0f)
+        clearance--;
+    };
+
+    // Move whole pixels, then the remaining fraction
+    while (abs(dx) >= 1)
     {
-        if (moveEntityLeft(entity))
+        if (!canMove())
         {
-            dx++;
-        }
-        else
-        {
-            entity.velocityX = 0.0f;
+            velocityX = 0;
             return;
         }
+        move(step);
+        dx -= step;
     }
-    if (dx < 0.0f)
+    if (dx != 0)
     {
-        if (std::floor(entity.positionX + dx) == std::floor(entity.positionX - 1))
+        if ((positionX + dx).floor() == (positionX + step).floor())
         {
-            if (canEntityMoveLeft(entity))
+            if (!canMove())
             {
-                moveEntityX(entity, dx);
-            }
-            else
-            {
-                entity.velocityX = 0.0f;
+                velocityX = 0;
                 return;
             }
+            move(dx);
         }
         else
         {
-            entity.positionX += dx;
+            positionX += dx;
         }
-        return;
     }
 }
 
 void Level::updateEntityMotionY(Entity& entity)
 {
-    // Move up/down one pixel at a time
-    float dy = entity.velocityY;
-    while (dy >= 1.0f)
+    Fixed& positionY = entityStore.positionY[entity.index];
+    Fixed& velocityY = entityStore.velocityY[entity.index];
+    Fixed dy = velocityY;
+    if (dy == 0)
     {
-        if (moveEntityDown(entity))
-        {
-            dy--;
-        }
-        else
-        {
-            entity.velocityY = 0.0f;
-            return;
-        }
-    }
-    if (dy > 0.0f)
-    {
-        if (std::floor(entity.positionY + dy) == std::floor(entity.positionY + 1))
-        {
-            if (canEntityMoveDown(entity))
-            {
-                moveEntityY(entity, dy);
-            }
-            else
-            {
-                entity.velocityY = 0.0f;
-                return;
-            }
-        }
-        else
-        {
-            entity.positionY += dy;
-        }
         return;
     }
-    while (dy <= -1.0f)
+    Fixed step = (dy > 0) ? 1 : -1;
+    int reach = abs(dy).floor() + 1;
+
+    // Sweep for the first obstacle once instead of checking every pixel
+    // (the entity can't move horizontally while moving vertically)
+    int clearance = (step > 0) ? getEntityClearanceDown(entity, reach) : getEntityClearanceUp(entity, reach);
+
+    // Move whole pixels, then the remaining fraction
+    while (abs(dy) >= 1)
     {
-        if (moveEntityUp(entity))
+        if (clearance <= 0)
         {
-            dy++;
-        }
-        else
-        {
-            entity.velocityY = 0.0f;
+            velocityY = 0;
             return;
         }
+        moveEntityY(entity, step);
+        clearance--;
+        dy -= step;
     }
-    if (dy < 0.0f)
+    if (dy != 0)
     {
-        if (std::floor(entity.positionY + dy) == std::floor(entity.positionY - 1))
+        if ((positionY + dy).floor() == (positionY + step).floor())
         {
-            if (canEntityMoveUp(entity))
-            {
-                moveEntityY(entity, dy);
-            }
-            else
+            if (clearance <= 0)
             {
-                entity.velocityY = 0.0f;
+                velocityY = 0;
                 return;
             }
+            moveEntityY(entity, dy);
         }
         else
         {
-            entity.positionY += dy;
+            positionY += dy;
         }
-        return;
     }
 }
 
 void Level::updateLayer(Layer& layer)
 {
     updateLayerMotionX(layer);
+    refitLayer(layer);
     updateLayerMotionY(layer);
+    refitLayer(layer);
 }
 
 void Level::updateLayerMotionX(Layer& layer)
 {
     // Move left/right one pixel at a time
-    float dx = layer.velocityX;
-    while (dx >= 1.0f)
+    Fixed dx = layer.velocityX;
+    while (dx >= 1)
     {
         moveLayerRight(layer);
         dx--;
     }
-    if (dx > 0.0f)
+    if (dx > 0)
     {
-        if (std::floor(layer.positionX + dx) == std::floor(layer.positionX + 1))
+        if ((layer.positionX + dx).floor() == (layer.positionX + 1).floor())
         {
             moveLayerRight(layer);
             layer.positionX--;
@@ -619,14 +859,14 @@ void Level::updateLayerMotionX(Layer& layer)
         layer.positionX += dx;
         return;
     }
-    while (dx <= -1.0f)
+    while (dx <= -1)
     {
         moveLayerLeft(layer);
         dx++;
     }
-    if (dx < 0.0f)
+    if (dx < 0)
     {
-        if (std::floor(layer.positionX + dx) == std::floor(layer.positionX - 1))
+        if ((layer.positionX + dx).floor() == (layer.positionX - 1).floor())
         {
             moveLayerLeft(layer);
             layer.positionX++;
@@ -639,15 +879,15 @@ void Level::updateLayerMotionX(Layer& layer)
 void Level::updateLayerMotionY(Layer& layer)
 {
     // Move up/down one pixel at a time
-    float dy = layer.velocityY;
-    while (dy >= 1.0f)
+    Fixed dy = layer.velocityY;
+    while (dy >= 1)
     {
         moveLayerDown(layer);
         dy--;
     }
-    if (dy > 0.0f)
+    if (dy > 0)
     {
-        if (std::floor(layer.positionY + dy) == std::floor(layer.positionY + 1))
+        if ((layer.positionY + dy).floor() == (layer.positionY + 1).floor())
         {
             moveLayerDown(layer);
             layer.positionY--;
@@ -655,14 +895,14 @@ void Level::updateLayerMotionY(Layer& layer)
         layer.positionY += dy;
         return;
     }
-    while (dy <= -1.0f)
+    while (dy <= -1)
     {
         moveLayerUp(layer);
         dy++;
     }
-    if (dy < 0.0f)
+    if (dy < 0)
     {
-        if (std::floor(layer.positionY + dy) == std::floor(layer.positionY - 1))
+        if ((layer.positionY + dy).floor() == (layer.positionY - 1).floor())
         {
             moveLayerUp(layer);
             layer.positionY++;
@@ -1,10 +1,19 @@
 #ifndef LEVEL_HPP
 #define LEVEL_HPP
 
-#include <list>
+#include <cstdint>
+#include <vector>
 
+#include "../util/Arena.hpp"
+#include "../util/Fixed.hpp"
+#include "../video/Geometry.hpp"
+
+#include "EntityGrid.hpp"
+#include "EntityStore.hpp"
+#include "LayerTree.hpp"
+
+class Block;
 class Entity;
-class Layer;
 class VideoManager;
 
 /**
@@ -12,6 +21,9 @@ class VideoManager;
  */
 class Level
 {
+    friend class Entity;
+    friend class Layer;
+    friend class LevelFile;
 public:
     /**
      * The size of a tile unit, in pixels.
@@ -22,25 +34,76 @@ public:
     ~Level();
 
     /**
-     * Add an entity to the level.
+     * Add a layer to the level.
+     *
+     * @param layer a layer created with createLayer().
      */
-    void addEntity(Entity* entity);
+    void addLayer(Layer* layer);
 
     /**
-     * Add a layer to the level.
+     * Create an entity in the level's memory and add it to the level.
+     *
+     * @param args the arguments to the entity's constructor.
      */
-    void addLayer(Layer* layer);
+    template <typename T, typename... Args>
+    T* createEntity(Args&&... args);
+
+    /**
+     * Create a layer in the level's memory, to be filled with blocks and then
+     * added with addLayer().
+     *
+     * @param width the width of the layer, in tiles.
+     * @param height the height of the layer, in tiles.
+     */
+    Layer* createLayer(int width, int height);
+
+    /**
+     * Find the layer that an entity is standing on, or nullptr if it is in the air.
+     */
+    const Layer* findGroundLayer(const Entity& entity) const;
+
+    /**
+     * Get the bottom edge of the level's layers, in pixels.
+     */
+    int getBottom() const;
+
+    /**
+     * Get the left edge of the level's layers, in pixels.
+     */
+    int getLeft() const;
+
+    /**
+     * Get the right edge of the level's layers, in pixels.
+     */
+    int getRight() const;
+
+    /**
+     * Get a hash of the positions and velocities of the level's layers and
+     * entities, for checking that two runs simulated the same thing.
+     */
+    uint64_t getStateHash() const;
 
     /**
-     * Check if an entity is standing on the ground of the level (i.e. not in the air).
+     * Get the top edge of the level's layers, in pixels.
      */
-    bool isEntityOnGround(const Entity& entity) const;
+    int getTop() const;
 
     /**
      * Check if a position in the level is underwater.
      */
     bool isUnderwaterAt(int x, int y) const;
 
+    /**
+     * Remove an entity from the level.
+     *
+     * The entity's memory still belongs to the level, and is freed along
+     * with it. If called while entities are being updated (for example from
+     * an entity's onUpdate()), the entity is removed once all of them have
+     * been updated, so every entity in the level at the start of the update
+     * is updated exactly once.
+     */
+    void removeEntity(Entity* entity);
+
     /**
      * Render the level.
      *
@@ -49,8 +112,19 @@ public:
      * @param right the right coordinate for the camera rectangle, in pixels.
      * @param top the top coordinate for the camera rectangle, in pixels.
      * @param bottom the bottom coordinate for the camera rectangle, in pixels.
+     * @param interpolation how far to interpolate entities and layers from their
+     * positions before the last update (0) to their current positions (1).
      */
-    void render(VideoManager& video, int left, int right, int top, int bottom) const;
+    void render(VideoManager& video, int left, int right, int top, int bottom, Fixed interpolation = 1) const;
+
+    /**
+     * Update the cached contacts of an entity with the level (ground, water).
+     *
+     * The contacts are only found again if the entity has moved, or a layer
+     * overlapping the entity or the row below it has moved, been added or had
+     * blocks added, since they were last found.
+     */
+    void updateEntityContacts(const Entity& entity) const;
 
     /**
      * Update the level by one frame.
@@ -58,25 +132,75 @@ public:
     void update();
 
 private:
-    std::list<Entity*> entities;
-    std::list<Layer*> layers;
+    /**
+     * The width of the columns that layer geometry is split into, in tiles.
+     */
+    static constexpr int GEOMETRY_CHUNK_WIDTH = 64;
+
+    /**
+     * Retained geometry of the blocks in a layer, split into columns so that
+     * only the columns near the camera are drawn.
+     */
+    struct LayerGeometry
+    {
+        unsigned revision; /**< Revision of the layer that the geometry was built from, or 0. */
+        int overhang; /**< Furthest that any column's blocks reach past its right edge, in pixels. */
+        std::vector<Geometry> chunks; /**< Geometry of the blocks starting in each column, in layer coordinates. */
+    };
 
+    Arena arena; /**< Owns the level's layers, tile chunks and entities. Declared first, so it is destroyed last. */
+    EntityStore entityStore;
+    std::vector<Layer*> layers;
+    EntityGrid entityGrid;
+    mutable LayerTree layerTree; /**< Bounding volume hierarchy of the layers, built by getLayerTree(). */
+    std::vector<Entity*> nearbyEntities; /**< Scratch list for entity grid queries. */
+    std::vector<int> nearbyLayers; /**< Scratch list for layer tree queries. */
+    mutable std::vector<Entity*> visibleEntities; /**< Scratch list for the entities being rendered. */
+    mutable std::vector<int> visibleLayers; /**< Scratch list for the layers being rendered. */
+    mutable std::vector<LayerGeometry> layerGeometry; /**< Geometry of each layer, built when first rendered. */
+    mutable bool layerTreeDirty; /**< Whether layers have been added since the layer tree was built. */
+    unsigned long long layerRevision; /**< Incremented whenever a layer moves, is added or has blocks added. */
+    int entityRenderMargin; /**< How far outside the camera rectangle to look for entities to render, in pixels. */
+    bool updatingEntities; /**< Whether entities' onUpdate() is being called, during which removals are deferred. */
+    std::vector<Entity*> removedEntities; /**< Entities to remove once entities have been updated. */
+
+    void addBlockGeometry(Geometry& geometry, const Block& block, int x, int y) const;
+    void addEntity(Entity* entity);
+    void buildLayerGeometry(const Layer& layer, LayerGeometry& geometry) const;
     bool canEntityMoveDown(Entity& entity) const;
     bool canEntityMoveLeft(Entity& entity) const;
     bool canEntityMoveRight(Entity& entity) const;
     bool canEntityMoveUp(Entity& entity) const;
+    int getEntityClearanceDown(const Entity& entity, int maxDistance) const;
+    int getEntityClearanceLeft(const Entity& entity, int maxDistance) const;
+    int getEntityClearanceRight(const Entity& entity, int maxDistance) const;
+    int getEntityClearanceUp(const Entity& entity, int maxDistance) const;
+
+    /**
+     * Get the layer tree, first building it if layers have been added.
+     */
+    const LayerTree& getLayerTree() const;
+    void findEntitiesNearLayer(const Layer& layer);
     bool isEntityStandingOnLayer(const Layer& layer, const Entity& entity) const;
+    bool isSlopeNearEntity(const Entity& entity, int distance) const;
+
+    /**
+     * Record that a layer has been added, moved or had blocks added, for
+     * checking whether cached entity contacts still hold.
+     */
+    void markLayerChanged(Layer& layer);
+
     bool moveEntityDown(Entity& entity);
     bool moveEntityLeft(Entity& entity);
     bool moveEntityRight(Entity& entity);
     bool moveEntityUp(Entity& entity);
-    void moveEntityX(Entity& entity, float dx);
-    void moveEntityY(Entity& entity, float dy);
+    void moveEntityX(Entity& entity, Fixed dx);
+    void moveEntityY(Entity& entity, Fixed dy);
     void moveLayerDown(Layer& layer);
     void moveLayerLeft(Layer& layer);
     void moveLayerRight(Layer& layer);
     void moveLayerUp(Layer& layer);
-    void updateEntity(Entity& entity);
+    void refitLayer(Layer& layer);
     void updateEntityMotionX(Entity& entity);
     void updateEntityMotionY(Entity& entity);
     void updateLayer(Layer& layer);
@@ -84,4 +208,12 @@ private:
     void updateLayerMotionY(Layer& layer);
 };
 
+template <typename T, typename... Args>
+T* Level::createEntity(Args&&... args)
+{
+    T* entity = arena.create<T>(std::forward<Args>(args)...);
+    addEntity(entity);
+    return entity;
+}
+
 #endif // LEVEL_HPP
@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#ifdef _WIN32
+// Keep windows.h from defining min() and max() macros, which break std::max()
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Block.hpp"
+#include "Layer.hpp"
+#include "Level.hpp"
+#include "LevelFile.hpp"
+
+static const char MAGIC[4] = {'J', 'L', 'V', 'L'};
+
+/**
+ * The largest width or height of a layer, in tiles. Positions are 24.8 fixed
+ * point, so pixel coordinates are limited to 2^23; this keeps every tile of a
+ * layer placed at the origin within that.
+ */
+static constexpr uint32_t MAX_LAYER_SIZE = (1 << 23) / Level::TILE_SIZE;
+
+/**
+ * The largest number of tile chunks in all layers, which keeps the layers'
+ * tables of chunks (one pointer per chunk) to a few megabytes.
+ */
+static constexpr uint64_t MAX_CHUNK_SLOTS = 1 << 22;
+
+/**
+ * The largest number of tile chunks that the placed blocks may allocate,
+ * at about 13 KB each.
+ */
+static constexpr uint64_t MAX_ALLOCATED_CHUNKS = 1 << 15;
+
+/**
+ * The largest total area of the placed blocks, in tiles, counting only the
+ * tiles inside their layers. Bounds the time taken to build the level.
+ */
+static constexpr uint64_t MAX_PLACED_TILES = 1 << 26;
+
+/**
+ * Check if the machine stores integers little-endian, like the level format.
+ */
+static bool isLittleEndian()
+{
+    uint32_t one = 1;
+    unsigned char firstByte;
+    std::memcpy(&firstByte, &one, 1);
+    return firstByte == 1;
+}
+
+LevelFile::LevelFile(const char* path) :
+    data(nullptr),
+    size(0),
+    mapping(nullptr)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error(std::string("Failed to open level file ") + path);
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(Header)))
+    {
+        CloseHandle(file);
+        throw std::runtime_error(std::string("Level file is too small: ") + path);
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+    {
+        throw std::runtime_error(std::string("Failed to map level file ") + path);
+    }
+    data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr)
+    {
+        CloseHandle(mapping);
+        throw std::runtime_error(std::string("Failed to map level file ") + path);
+    }
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        throw std::runtime_error(std::string("Failed to open level file ") + path);
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(Header)))
+    {
+        close(file);
+        throw std::runtime_error(std::string("Level file is too small: ") + path);
+    }
+    size = static_cast<size_t>(status.st_size);
+    void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (address == MAP_FAILED)
+    {
+        throw std::runtime_error(std::string("Failed to map level file ") + path);
+    }
+    data = static_cast<const char*>(address);
+#endif
+
+    try
+    {
+        validate();
+    }
+    catch (...)
+    {
+        unmap();
+        throw;
+    }
+}
+
+LevelFile::~LevelFile()
+{
+    unmap();
+}
+
+Level* LevelFile::createLevel() const
+{
+    std::vector<const Block*> definitions;
+    definitions.reserve(header->blockCount);
+    for (uint32_t i = 0; i < header->blockCount; i++)
+    {
+        definitions.push_back(Block::get(
+            static_cast<Block::CollisionType>(blocks[i].collisionType),
+            blocks[i].width,
+            blocks[i].height
+        ));
+    }
+
+    Level* level = new Level();
+    for (uint32_t i = 0; i < header->layerCount; i++)
+    {
+        const LayerRecord& record = layers[i];
+        Layer* layer = level->createLayer(record.width, record.height);
+        layer->setX(Fixed::fromRaw(record.positionX));
+        layer->setY(Fixed::fromRaw(record.positionY));
+        layer->setVelocityX(Fixed::fromRaw(record.velocityX));
+        layer->setVelocityY(Fixed::fromRaw(record.velocityY));
+
+        const Placement* placement = placements + record.firstPlacement;
+        for (uint32_t j = 0; j < record.placementCount; j++, placement++)
+        {
+            layer->addBlock(placement->x, placement->y, definitions[placement->block]);
+        }
+
+        level->addLayer(layer);
+    }
+    return level;
+}
+
+const LevelFile::Spawn* LevelFile::getSpawns() const
+{
+    return spawns;
+}
+
+int LevelFile::getSpawnCount() const
+{
+    return header->spawnCount;
+}
+
+void LevelFile::unmap()
+{
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+#else
+    munmap(const_cast<char*>(data), size);
+#endif
+    data = nullptr;
+    mapping = nullptr;
+}
+
+void LevelFile::validate()
+{
+    if (!isLittleEndian())
+    {
+        throw std::runtime_error("Level files can only be read on little-endian machines");
+    }
+
+    header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        throw std::runtime_error("Not a level file");
+    }
+    if (header->version != VERSION)
+    {
+        throw std::runtime_error("Unsupported level file version " + std::to_string(header->version));
+    }
+
+    // Find the arrays of records, checking that they fit in the file
+    uint64_t offset = sizeof(Header);
+    uint64_t blocksOffset = offset;
+    offset += static_cast<uint64_t>(header->blockCount) * sizeof(BlockDefinition);
+    uint64_t layersOffset = offset;
+    offset += static_cast<uint64_t>(header->layerCount) * sizeof(LayerRecord);
+    uint64_t placementsOffset = offset;
+    offset += static_cast<uint64_t>(header->placementCount) * sizeof(Placement);
+    uint64_t spawnsOffset = offset;
+    offset += static_cast<uint64_t>(header->spawnCount) * sizeof(Spawn);
+    if (offset > size)
+    {
+        throw std::runtime_error("Level file is truncated");
+    }
+    blocks = reinterpret_cast<const BlockDefinition*>(data + blocksOffset);
+    layers = reinterpret_cast<const LayerRecord*>(data + layersOffset);
+    placements = reinterpret_cast<const Placement*>(data + placementsOffset);
+    spawns = reinterpret_cast<const Spawn*>(data + spawnsOffset);
+
+    // Check the records that refer to others, so that building the level
+    // doesn't need to
+    for (uint32_t i = 0; i < header->blockCount; i++)
+    {
+        if (blocks[i].collisionType > static_cast<uint32_t>(Block::CollisionType::WATER) ||
+            blocks[i].width == 0 || blocks[i].height == 0 ||
+            blocks[i].width > Layer::MAX_BLOCK_SIZE || blocks[i].height > Layer::MAX_BLOCK_SIZE)
+        {
+            throw std::runtime_error("Invalid block definition " + std::to_string(i));
+        }
+    }
+    for (uint32_t i = 0; i < header->placementCount; i++)
+    {
+        if (placements[i].block >= header->blockCount)
+        {
+            throw std::runtime_error("Invalid block in placement " + std::to_string(i));
+        }
+    }
+
+    // Check the layers, and that building them stays within the memory and
+    // time budgets however large or overlapping the placed blocks are
+    uint64_t chunkSlots = 0;
+    uint64_t allocatedChunks = 0;
+    uint64_t placedTiles = 0;
+    for (uint32_t i = 0; i < header->layerCount; i++)
+    {
+        const LayerRecord& layer = layers[i];
+        if (layer.width > MAX_LAYER_SIZE || layer.height > MAX_LAYER_SIZE)
+        {
+            throw std::runtime_error("Layer " + std::to_string(i) + " is too large");
+        }
+        int64_t chunksWide = (static_cast<int64_t>(layer.width) + Layer::CHUNK_SIZE - 1) / Layer::CHUNK_SIZE;
+        int64_t chunksHigh = (static_cast<int64_t>(layer.height) + Layer::CHUNK_SIZE - 1) / Layer::CHUNK_SIZE;
+        chunkSlots += chunksWide * chunksHigh;
+        if (chunkSlots > MAX_CHUNK_SLOTS)
+        {
+            throw std::runtime_error("Level layers are too large");
+        }
+        if (static_cast<uint64_t>(layer.firstPlacement) + layer.placementCount > header->placementCount)
+        {
+            throw std::runtime_error("Invalid placements in layer " + std::to_string(i));
+        }
+
+        std::vector<bool> chunkAllocated(chunksWide * chunksHigh, false);
+        for (uint32_t j = layer.firstPlacement; j < layer.firstPlacement + layer.placementCount; j++)
+        {
+            // Every placed block must overlap the layer
+            const Placement& placement = placements[j];
+            const BlockDefinition& block = blocks[placement.block];
+            int64_t left = std::max<int64_t>(placement.x, 0);
+            int64_t top = std::max<int64_t>(placement.y, 0);
+            int64_t right = std::min<int64_t>(static_cast<int64_t>(placement.x) + block.width, layer.width);
+            int64_t bottom = std::min<int64_t>(static_cast<int64_t>(placement.y) + block.height, layer.height);
+            if (left >= right || top >= bottom)
+            {
+                throw std::runtime_error("Placement " + std::to_string(j) + " is outside layer " + std::to_string(i));
+            }
+
+            placedTiles += (right - left) * (bottom - top);
+            if (placedTiles > MAX_PLACED_TILES)
+            {
+                throw std::runtime_error("Level places too many tiles");
+            }
+
+            // Count the chunks that the block's tiles need allocated, which
+            // are never more than the tiles counted above
+            for (int64_t y = top / Layer::CHUNK_SIZE; y <= (bottom - 1) / Layer::CHUNK_SIZE; y++)
+            {
+                for (int64_t x = left / Layer::CHUNK_SIZE; x <= (right - 1) / Layer::CHUNK_SIZE; x++)
+                {
+                    std::vector<bool>::reference allocated = chunkAllocated[y * chunksWide + x];
+                    if (!allocated)
+                    {
+                        allocated = true;
+                        allocatedChunks++;
+                    }
+                }
+            }
+            if (allocatedChunks > MAX_ALLOCATED_CHUNKS)
+            {
+                throw std::runtime_error("Level allocates too many tile chunks");
+            }
+        }
+    }
+}
+
+void LevelFile::write(const char* path, const Level& level, const std::vector<Spawn>& spawns)
+{
+    if (!isLittleEndian())
+    {
+        throw std::runtime_error("Level files can only be written on little-endian machines");
+    }
+
+    std::vector<BlockDefinition> blocks;
+    std::vector<LayerRecord> layers;
+    std::vector<Placement> placements;
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t>, uint32_t> blockIndices;
+
+    for (auto layer : level.layers)
+    {
+        LayerRecord record;
+        record.positionX = layer->positionX.getRaw();
+        record.positionY = layer->positionY.getRaw();
+        record.velocityX = layer->velocityX.getRaw();
+        record.velocityY = layer->velocityY.getRaw();
+        record.width = layer->width;
+        record.height = layer->height;
+        record.firstPlacement = placements.size();
+
+        // Keep the blocks in the order they were placed, so that blocks placed
+        // over others replace them again when the file is read
+        for (const Layer::Placement& placement : layer->placements)
+        {
+            const Block* block = placement.block;
+            auto key = std::make_tuple(static_cast<uint32_t>(block->collisionType),
+                                       static_cast<uint32_t>(block->width),
+                                       static_cast<uint32_t>(block->height));
+            auto index = blockIndices.find(key);
+            if (index == blockIndices.end())
+            {
+                index = blockIndices.insert({key, static_cast<uint32_t>(blocks.size())}).first;
+                blocks.push_back({std::get<0>(key), std::get<1>(key), std::get<2>(key)});
+            }
+            placements.push_back({placement.x, placement.y, index->second});
+        }
+
+        record.placementCount = placements.size() - record.firstPlacement;
+        layers.push_back(record);
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.blockCount = blocks.size();
+    header.layerCount = layers.size();
+    header.placementCount = placements.size();
+    header.spawnCount = spawns.size();
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(BlockDefinition));
+    file.write(reinterpret_cast<const char*>(layers.data()), layers.size() * sizeof(LayerRecord));
+    file.write(reinterpret_cast<const char*>(placements.data()), placements.size() * sizeof(Placement));
+    file.write(reinterpret_cast<const char*>(spawns.data()), spawns.size() * sizeof(Spawn));
+    if (!file)
+    {
+        throw std::runtime_error(std::string("Failed to write level file ") + path);
+    }
+}
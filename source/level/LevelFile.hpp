@@ -0,0 +1,151 @@
+#ifndef LEVELFILE_HPP
+#define LEVELFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Level;
+
+/**
+ * A level stored in the binary level format, mapped into memory.
+ *
+ * The file is a header followed by arrays of fixed-size records, all made of
+ * 32-bit little-endian fields so that the records can be read in place:
+ *
+ * - Header
+ * - BlockDefinition[blockCount]
+ * - LayerRecord[layerCount]
+ * - Placement[placementCount], grouped by layer
+ * - Spawn[spawnCount]
+ *
+ * Layers list the blocks placed in them rather than storing a full tile grid,
+ * so that large, mostly empty layers stay small.
+ */
+class LevelFile
+{
+public:
+    /**
+     * The version of the format written and accepted by this class.
+     */
+    static constexpr uint32_t VERSION = 1;
+
+    /**
+     * Kinds of entities that can be spawned.
+     */
+    enum SpawnType : uint32_t
+    {
+        SPAWN_PLAYER = 0
+    };
+
+    /**
+     * The start of a level file.
+     */
+    struct Header
+    {
+        char magic[4]; /**< Always "JLVL". */
+        uint32_t version;
+        uint32_t blockCount;
+        uint32_t layerCount;
+        uint32_t placementCount;
+        uint32_t spawnCount;
+    };
+
+    /**
+     * A kind of block that is placed in layers.
+     */
+    struct BlockDefinition
+    {
+        uint32_t collisionType; /**< A Block::CollisionType. */
+        uint32_t width;  /**< Width, in tiles. */
+        uint32_t height; /**< Height, in tiles. */
+    };
+
+    /**
+     * A layer of the level.
+     */
+    struct LayerRecord
+    {
+        int32_t positionX; /**< Raw fixed-point x position, in pixels. */
+        int32_t positionY; /**< Raw fixed-point y position, in pixels. */
+        int32_t velocityX; /**< Raw fixed-point x velocity, in pixels/frame. */
+        int32_t velocityY; /**< Raw fixed-point y velocity, in pixels/frame. */
+        uint32_t width;  /**< Width, in tiles. */
+        uint32_t height; /**< Height, in tiles. */
+        uint32_t firstPlacement; /**< Index of the layer's first placement. */
+        uint32_t placementCount; /**< Number of placements in the layer. */
+    };
+
+    /**
+     * A block placed in a layer.
+     */
+    struct Placement
+    {
+        int32_t x; /**< Left position in the layer, in tiles. */
+        int32_t y; /**< Top position in the layer, in tiles. */
+        uint32_t block; /**< Index of the block definition. */
+    };
+
+    /**
+     * An entity to spawn when the level starts.
+     */
+    struct Spawn
+    {
+        uint32_t type; /**< A SpawnType. */
+        int32_t x; /**< Left position, in pixels. */
+        int32_t y; /**< Top position, in pixels. */
+    };
+
+    /**
+     * Map a level file into memory and check that it is valid.
+     *
+     * @throws std::runtime_error if the file cannot be read or is invalid.
+     */
+    LevelFile(const char* path);
+
+    ~LevelFile();
+
+    LevelFile(const LevelFile&) = delete;
+    LevelFile& operator=(const LevelFile&) = delete;
+
+    /**
+     * Build a new level from the file's layers and blocks.
+     *
+     * Entities are not spawned; see getSpawns().
+     */
+    Level* createLevel() const;
+
+    /**
+     * Get the entities to spawn when the level starts.
+     */
+    const Spawn* getSpawns() const;
+
+    /**
+     * Get the number of entities to spawn when the level starts.
+     */
+    int getSpawnCount() const;
+
+    /**
+     * Write the layers and blocks of a level to a level file.
+     *
+     * @param spawns the entities to spawn when the level starts.
+     * @throws std::runtime_error if the file cannot be written, or the
+     * machine is not little-endian.
+     */
+    static void write(const char* path, const Level& level, const std::vector<Spawn>& spawns);
+
+private:
+    const char* data; /**< Start of the mapped file. */
+    size_t size; /**< Size of the mapped file, in bytes. */
+    void* mapping; /**< Handle of the file mapping, on platforms that need one. */
+    const Header* header;
+    const BlockDefinition* blocks;
+    const LayerRecord* layers;
+    const Placement* placements;
+    const Spawn* spawns;
+
+    void unmap();
+    void validate();
+};
+
+#endif // LEVELFILE_HPP
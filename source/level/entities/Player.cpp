@@ -1,30 +1,55 @@
 #include <cmath>
 
 #include "../../input/InputManager.hpp"
+#include "../../util/LatencyTracker.hpp"
 #include "../Level.hpp"
 
 #include "Player.hpp"
 
+constexpr Fixed Player::MAX_WALKING_SPEED;
+constexpr Fixed Player::MAX_RUNNING_SPEED;
+constexpr Fixed Player::RUN_ACCELERATION;
+constexpr Fixed Player::STOP_DECELERATION;
+constexpr Fixed Player::SKID_DECELERATION;
+constexpr Fixed Player::JUMP_VELOCITY_1;
+constexpr Fixed Player::JUMP_VELOCITY_2;
+constexpr Fixed Player::JUMP_VELOCITY_3;
+constexpr Fixed Player::JUMP_VELOCITY_THRESHOLD_2;
+constexpr Fixed Player::JUMP_VELOCITY_THRESHOLD_3;
+constexpr Fixed Player::JUMP_GRAVITY_1;
+constexpr Fixed Player::JUMP_GRAVITY_2;
+constexpr Fixed Player::JUMP_GRAVITY_THRESHOLD_2;
+constexpr Fixed Player::MAX_DOWNWARD_VELOCITY;
+constexpr Fixed Player::MAX_UNDERWATER_WALKING_SPEED;
+constexpr Fixed Player::UNDERWATER_GRAVITY_MOVING_UPWARD;
+constexpr Fixed Player::UNDERWATER_GRAVITY_MOVING_DOWNWARD;
+constexpr Fixed Player::UNDERWATER_GRAVITY_AT_SURFACE;
+constexpr Fixed Player::MAX_UNDERWATER_DOWNWARD_VELOCITY;
+constexpr Fixed Player::MAX_SWIMMING_SPEED;
+constexpr Fixed Player::UNDERWATER_ACCELERATION;
+constexpr Fixed Player::UNDERWATER_DECELERATION;
+constexpr Fixed Player::UNDERWATER_TURN_ACCELERATION;
+constexpr Fixed Player::UNDERWATER_JUMP_VELOCITY;
+constexpr Fixed Player::SWIM_POWER_MODIFIER;
+constexpr Fixed Player::MAX_SWIM_POWER;
+constexpr Fixed Player::MIN_SWIM_POWER;
+
 Player::Player() :
     directionSign(1),
     maxAirVelocityX(MAX_WALKING_SPEED),
-    wasAtSurfaceOfWaterLastFrame(false)
-{
-}
-
-bool Player::isAtSurfaceOfWater() const
+    wasAtSurfaceOfWaterLastFrame(false),
+    turnPressPending(false)
 {
-    return !(getLevel().isUnderwaterAt(getCenterX(), getTop())) && isUnderwater();
 }
 
-void Player::onButtonPress(InputButton buttonId)
+void Player::onButtonPress(InputButton buttonId, std::chrono::steady_clock::time_point time)
 {
     if (buttonId == InputButton::A)
     {
         // Jump if we are on the ground or underwater
         if (isUnderwater())
         {
-            float swimPower = getVelocityY() - SWIM_POWER_MODIFIER;
+            Fixed swimPower = getVelocityY() - SWIM_POWER_MODIFIER;
             if (swimPower < MIN_SWIM_POWER)
             {
                 swimPower = MIN_SWIM_POWER;
@@ -34,10 +59,11 @@ void Player::onButtonPress(InputButton buttonId)
                 swimPower = MAX_SWIM_POWER;
             }
             setVelocityY(swimPower);
+            LATENCY_INPUT(time);
         }
         else if (isOnGround())
         {
-            float velocityX = std::fabs(getVelocityX());
+            Fixed velocityX = abs(getVelocityX());
             if (velocityX > JUMP_VELOCITY_THRESHOLD_3)
             {
                 setVelocityY(-1 * JUMP_VELOCITY_3);
@@ -51,8 +77,15 @@ void Player::onButtonPress(InputButton buttonId)
                 setVelocityY(-1 * JUMP_VELOCITY_1);
             }
             setAccelerationY(JUMP_GRAVITY_1);
+            LATENCY_INPUT(time);
         }
     }
+    else if (buttonId == InputButton::LEFT || buttonId == InputButton::RIGHT)
+    {
+        // onUpdate() reacts to it
+        turnPressTime = time;
+        turnPressPending = true;
+    }
 }
 
 void Player::onUpdate()
@@ -73,12 +106,18 @@ void Player::onUpdate()
     {
         stopping = true;
     }
+    if (turnPressPending && !stopping)
+    {
+        // The acceleration set below moves the player in the next update
+        LATENCY_INPUT(turnPressTime);
+    }
+    turnPressPending = false;
 
     bool atSurfaceOfWaterThisFrame = false;
     if (isUnderwater()) // Underwater physics
     {
         // Cap x velocity
-        float maximumVelocityX;
+        Fixed maximumVelocityX;
         if (isOnGround()) // Walking underwater
         {
             maximumVelocityX = MAX_UNDERWATER_WALKING_SPEED;
@@ -87,7 +126,7 @@ void Player::onUpdate()
         {
             maximumVelocityX = MAX_SWIMMING_SPEED;
         }
-        if (std::fabs(getVelocityX()) > maximumVelocityX)
+        if (abs(getVelocityX()) > maximumVelocityX)
         {
             setVelocityX(maximumVelocityX * sgn(getVelocityX()));
         }
@@ -95,7 +134,7 @@ void Player::onUpdate()
         // Determine x acceleration
         if (stopping)
         {
-            if (std::fabs(getVelocityX()) > UNDERWATER_DECELERATION)
+            if (abs(getVelocityX()) > UNDERWATER_DECELERATION)
             {
                 setAccelerationX(-1 * sgn(getVelocityX()) * UNDERWATER_DECELERATION);
             }
@@ -157,12 +196,12 @@ void Player::onUpdate()
         if (isOnGround())
         {
             // Cap x velocity
-            float maximumVelocityX = MAX_WALKING_SPEED;
+            Fixed maximumVelocityX = MAX_WALKING_SPEED;
             if (input.isButtonPressed(InputButton::B))
             {
                 maximumVelocityX = MAX_RUNNING_SPEED;
             }
-            if (std::fabs(getVelocityX()) > maximumVelocityX)
+            if (abs(getVelocityX()) > maximumVelocityX)
             {
                 setVelocityX(maximumVelocityX * sgn(getVelocityX()));
             }
@@ -182,7 +221,7 @@ void Player::onUpdate()
         // Determine x acceleration
         if (stopping)
         {
-            if (std::fabs(getVelocityX()) > STOP_DECELERATION)
+            if (abs(getVelocityX()) > STOP_DECELERATION)
             {
                 setAccelerationX(-1 * sgn(getVelocityX()) * STOP_DECELERATION);
             }
@@ -16,53 +16,54 @@ public:
 private:
     // Physics constants:
 
-    static constexpr float MAX_WALKING_SPEED = physicsValueFromHex(0x0180);
-    static constexpr float MAX_RUNNING_SPEED = physicsValueFromHex(0x0280);
+    static constexpr Fixed MAX_WALKING_SPEED = physicsValueFromHex(0x0180);
+    static constexpr Fixed MAX_RUNNING_SPEED = physicsValueFromHex(0x0280);
 
-    static constexpr float RUN_ACCELERATION = physicsValueFromHex(0x000e);
-    static constexpr float STOP_DECELERATION = physicsValueFromHex(0x000e);
-    static constexpr float SKID_DECELERATION = physicsValueFromHex(0x0020);
+    static constexpr Fixed RUN_ACCELERATION = physicsValueFromHex(0x000e);
+    static constexpr Fixed STOP_DECELERATION = physicsValueFromHex(0x000e);
+    static constexpr Fixed SKID_DECELERATION = physicsValueFromHex(0x0020);
 
-    static constexpr float JUMP_VELOCITY_1 = physicsValueFromHex(0x0370);
-    static constexpr float JUMP_VELOCITY_2 = physicsValueFromHex(0x0390);
-    static constexpr float JUMP_VELOCITY_3 = physicsValueFromHex(0x03b0);
+    static constexpr Fixed JUMP_VELOCITY_1 = physicsValueFromHex(0x0370);
+    static constexpr Fixed JUMP_VELOCITY_2 = physicsValueFromHex(0x0390);
+    static constexpr Fixed JUMP_VELOCITY_3 = physicsValueFromHex(0x03b0);
 
-    static constexpr float JUMP_VELOCITY_THRESHOLD_2 = physicsValueFromHex(0x0100);
-    static constexpr float JUMP_VELOCITY_THRESHOLD_3 = physicsValueFromHex(0x0200);
+    static constexpr Fixed JUMP_VELOCITY_THRESHOLD_2 = physicsValueFromHex(0x0100);
+    static constexpr Fixed JUMP_VELOCITY_THRESHOLD_3 = physicsValueFromHex(0x0200);
 
-    static constexpr float JUMP_GRAVITY_1 = physicsValueFromHex(0x0010);
-    static constexpr float JUMP_GRAVITY_2 = physicsValueFromHex(0x0050);
+    static constexpr Fixed JUMP_GRAVITY_1 = physicsValueFromHex(0x0010);
+    static constexpr Fixed JUMP_GRAVITY_2 = physicsValueFromHex(0x0050);
 
-    static constexpr float JUMP_GRAVITY_THRESHOLD_2 = -1 * physicsValueFromHex(0x0200);
+    static constexpr Fixed JUMP_GRAVITY_THRESHOLD_2 = -1 * physicsValueFromHex(0x0200);
 
-    static constexpr float MAX_DOWNWARD_VELOCITY = physicsValueFromHex(0x0450);
+    static constexpr Fixed MAX_DOWNWARD_VELOCITY = physicsValueFromHex(0x0450);
 
-    static constexpr float MAX_UNDERWATER_WALKING_SPEED = physicsValueFromHex(0x0100);
+    static constexpr Fixed MAX_UNDERWATER_WALKING_SPEED = physicsValueFromHex(0x0100);
 
-    static constexpr float UNDERWATER_GRAVITY_MOVING_UPWARD = physicsValueFromHex(0x0010);
-    static constexpr float UNDERWATER_GRAVITY_MOVING_DOWNWARD = physicsValueFromHex(0x0008);
-    static constexpr float UNDERWATER_GRAVITY_AT_SURFACE = physicsValueFromHex(0x000c);
+    static constexpr Fixed UNDERWATER_GRAVITY_MOVING_UPWARD = physicsValueFromHex(0x0010);
+    static constexpr Fixed UNDERWATER_GRAVITY_MOVING_DOWNWARD = physicsValueFromHex(0x0008);
+    static constexpr Fixed UNDERWATER_GRAVITY_AT_SURFACE = physicsValueFromHex(0x000c);
 
-    static constexpr float MAX_UNDERWATER_DOWNWARD_VELOCITY = physicsValueFromHex(0x0200);
+    static constexpr Fixed MAX_UNDERWATER_DOWNWARD_VELOCITY = physicsValueFromHex(0x0200);
 
-    static constexpr float MAX_SWIMMING_SPEED = physicsValueFromHex(0x0300);
+    static constexpr Fixed MAX_SWIMMING_SPEED = physicsValueFromHex(0x0300);
 
-    static constexpr float UNDERWATER_ACCELERATION = physicsValueFromHex(0x0006);
-    static constexpr float UNDERWATER_DECELERATION = physicsValueFromHex(0x0002);
-    static constexpr float UNDERWATER_TURN_ACCELERATION = physicsValueFromHex(0x0008);
+    static constexpr Fixed UNDERWATER_ACCELERATION = physicsValueFromHex(0x0006);
+    static constexpr Fixed UNDERWATER_DECELERATION = physicsValueFromHex(0x0002);
+    static constexpr Fixed UNDERWATER_TURN_ACCELERATION = physicsValueFromHex(0x0008);
 
-    static constexpr float UNDERWATER_JUMP_VELOCITY = physicsValueFromHex(0x0330);
+    static constexpr Fixed UNDERWATER_JUMP_VELOCITY = physicsValueFromHex(0x0330);
 
-    static constexpr float SWIM_POWER_MODIFIER = physicsValueFromHex(0x01f0);
-    static constexpr float MAX_SWIM_POWER = physicsValueFromHex(0x0000);
-    static constexpr float MIN_SWIM_POWER = -1 * physicsValueFromHex(0x0200);
+    static constexpr Fixed SWIM_POWER_MODIFIER = physicsValueFromHex(0x01f0);
+    static constexpr Fixed MAX_SWIM_POWER = physicsValueFromHex(0x0000);
+    static constexpr Fixed MIN_SWIM_POWER = -1 * physicsValueFromHex(0x0200);
 
     int directionSign; /**< Sign that indicates the direction the player is facing. -1 for left, 1 for right. */
-    float maxAirVelocityX; /**< Maximum velocity during airborne movement. */
+    Fixed maxAirVelocityX; /**< Maximum velocity during airborne movement. */
     bool wasAtSurfaceOfWaterLastFrame; /**< Whether the player was at the surface of a body of water last frame. */
+    std::chrono::steady_clock::time_point turnPressTime; /**< When left or right was pressed, for measuring latency. */
+    bool turnPressPending; /**< Whether left or right was pressed since the last update. */
 
-    bool isAtSurfaceOfWater() const;
-    void onButtonPress(InputButton buttonId);
+    void onButtonPress(InputButton buttonId, std::chrono::steady_clock::time_point time);
     void onUpdate();
 };
 
@@ -7,27 +7,25 @@
 Level* createTestLevel()
 {
     Level* level = new Level();
+    const Block* solid = Block::get(Block::CollisionType::SOLID);
 
     // Main layer
-    Layer* mainLayer = new Layer(256, 15);
+    Layer* mainLayer = level->createLayer(256, 15);
     for (int x = 0; x < 256; x++)
     {
-        mainLayer->addBlock(x, 14, new Block(Block::CollisionType::SOLID));
-        mainLayer->addBlock(x, 0, new Block(Block::CollisionType::SOLID));
+        mainLayer->addBlock(x, 14, solid);
+        mainLayer->addBlock(x, 0, solid);
     }
     for (int y = 0; y < 15; y++)
     {
-        mainLayer->addBlock(0, y, new Block(Block::CollisionType::SOLID));
-        mainLayer->addBlock(255, y, new Block(Block::CollisionType::SOLID));
+        mainLayer->addBlock(0, y, solid);
+        mainLayer->addBlock(255, y, solid);
     }
-    mainLayer->addBlock(5, 13, new Block(Block::CollisionType::SLOPE_RIGHT));
-    mainLayer->addBlock(6, 13, new Block(Block::CollisionType::SLOPE_LEFT));
-    mainLayer->addBlock(9, 10, new Block(Block::CollisionType::SOLID));
+    mainLayer->addBlock(5, 13, Block::get(Block::CollisionType::SLOPE_RIGHT));
+    mainLayer->addBlock(6, 13, Block::get(Block::CollisionType::SLOPE_LEFT));
+    mainLayer->addBlock(9, 10, solid);
 
-    Block* water = new Block(Block::CollisionType::WATER);
-    water->setWidth(4);
-    water->setHeight(4);
-    mainLayer->addBlock(15, 10, water);
+    mainLayer->addBlock(15, 10, Block::get(Block::CollisionType::WATER, 4, 4));
 
     level->addLayer(mainLayer);
 
@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "Arena.hpp"
+
+constexpr size_t Arena::INITIAL_BLOCK_SIZE;
+constexpr size_t Arena::MAX_BLOCK_SIZE;
+
+Arena::Arena() :
+    nextBlockSize(INITIAL_BLOCK_SIZE),
+    current(nullptr),
+    end(nullptr),
+    destructors(nullptr)
+{
+}
+
+Arena::~Arena()
+{
+    for (Destructor* destructor = destructors; destructor != nullptr; destructor = destructor->next)
+    {
+        destructor->destroy(destructor->object);
+    }
+    for (auto block : blocks)
+    {
+        delete[] block;
+    }
+}
+
+void* Arena::allocate(size_t size, size_t alignment)
+{
+    uintptr_t address = (reinterpret_cast<uintptr_t>(current) + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    if (current == nullptr || address + size > reinterpret_cast<uintptr_t>(end))
+    {
+        // Start a new block, leaving the rest of the current one unused
+        size_t blockSize = std::max(nextBlockSize, size + alignment);
+        char* block = new char[blockSize];
+        blocks.push_back(block);
+        current = block;
+        end = block + blockSize;
+        nextBlockSize = std::min(nextBlockSize * 2, MAX_BLOCK_SIZE);
+        address = (reinterpret_cast<uintptr_t>(current) + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    }
+    current = reinterpret_cast<char*>(address + size);
+    return reinterpret_cast<void*>(address);
+}
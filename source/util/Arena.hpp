@@ -0,0 +1,99 @@
+/**
+ * @file defines a bump allocator for objects that are freed together
+ */
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Allocates objects contiguously from large blocks of memory, and destroys
+ * them all at once when the arena is destroyed.
+ *
+ * Objects created in an arena must not be deleted individually. Objects with
+ * destructors are destroyed in the reverse order of their creation.
+ */
+class Arena
+{
+public:
+    /**
+     * The size of the first block of memory, in bytes. Each following block
+     * is twice as large, up to MAX_BLOCK_SIZE.
+     */
+    static constexpr size_t INITIAL_BLOCK_SIZE = 64 * 1024;
+
+    /**
+     * The largest size of a block of memory, in bytes, unless a single
+     * allocation needs more.
+     */
+    static constexpr size_t MAX_BLOCK_SIZE = 4 * 1024 * 1024;
+
+    Arena();
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Allocate uninitialized memory.
+     *
+     * @param size the size of the memory, in bytes.
+     * @param alignment the alignment of the memory, as a power of two.
+     */
+    void* allocate(size_t size, size_t alignment);
+
+    /**
+     * Construct an object in the arena.
+     *
+     * The object is value-initialized when no arguments are given.
+     */
+    template <typename T, typename... Args>
+    T* create(Args&&... args);
+
+private:
+    /**
+     * A record of an object to destroy with the arena.
+     */
+    struct Destructor
+    {
+        void (*destroy)(void*);
+        void* object;
+        Destructor* next;
+    };
+
+    std::vector<char*> blocks;
+    size_t nextBlockSize; /**< Size of the next block to allocate, in bytes. */
+    char* current; /**< Start of the free memory in the current block. */
+    char* end; /**< End of the current block. */
+    Destructor* destructors; /**< Objects to destroy, most recently created first. */
+
+    template <typename T>
+    static void destroy(void* object);
+};
+
+template <typename T, typename... Args>
+T* Arena::create(Args&&... args)
+{
+    T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value)
+    {
+        Destructor* destructor = new (allocate(sizeof(Destructor), alignof(Destructor))) Destructor;
+        destructor->destroy = &destroy<T>;
+        destructor->object = object;
+        destructor->next = destructors;
+        destructors = destructor;
+    }
+    return object;
+}
+
+template <typename T>
+void Arena::destroy(void* object)
+{
+    static_cast<T*>(object)->~T();
+}
+
+#endif // ARENA_HPP
@@ -0,0 +1,167 @@
+/**
+ * @file defines a fixed-point number type for deterministic physics
+ */
+#ifndef FIXED_HPP
+#define FIXED_HPP
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * A signed 24.8 fixed-point number.
+ *
+ * Physics values are defined in units of 1/256 of a pixel (see
+ * physicsValueFromHex()), so they are represented exactly, and arithmetic on
+ * them gives the same results on every compiler and optimization level.
+ */
+class Fixed
+{
+public:
+    /**
+     * The number of bits after the binary point.
+     */
+    static constexpr int FRACTIONAL_BITS = 8;
+
+    /**
+     * The raw representation of 1.
+     */
+    static constexpr int32_t ONE = 1 << FRACTIONAL_BITS;
+
+    constexpr Fixed() : raw(0) {}
+
+    /**
+     * Convert an integer to a fixed-point number.
+     */
+    constexpr Fixed(int value) : raw(value * ONE) {}
+
+    /**
+     * Floating-point values must be converted with fromFloat(), rather than
+     * being silently truncated to an integer.
+     */
+    Fixed(float value) = delete;
+    Fixed(double value) = delete;
+
+    /**
+     * Convert a float to the nearest fixed-point number.
+     */
+    static Fixed fromFloat(float value)
+    {
+        return fromRaw(static_cast<int32_t>(std::lround(value * ONE)));
+    }
+
+    /**
+     * Create a fixed-point number from its raw representation.
+     */
+    static constexpr Fixed fromRaw(int32_t raw)
+    {
+        return Fixed(raw, 0);
+    }
+
+    /**
+     * Round down to an integer.
+     */
+    constexpr int floor() const
+    {
+        return raw >> FRACTIONAL_BITS;
+    }
+
+    /**
+     * Get the raw representation, in units of 1/256.
+     */
+    constexpr int32_t getRaw() const
+    {
+        return raw;
+    }
+
+    /**
+     * Convert to a float.
+     */
+    constexpr float toFloat() const
+    {
+        return static_cast<float>(raw) / ONE;
+    }
+
+    Fixed& operator+=(Fixed other)
+    {
+        raw += other.raw;
+        return *this;
+    }
+
+    Fixed& operator-=(Fixed other)
+    {
+        raw -= other.raw;
+        return *this;
+    }
+
+    Fixed& operator++()
+    {
+        raw += ONE;
+        return *this;
+    }
+
+    Fixed operator++(int)
+    {
+        Fixed old = *this;
+        raw += ONE;
+        return old;
+    }
+
+    Fixed& operator--()
+    {
+        raw -= ONE;
+        return *this;
+    }
+
+    Fixed operator--(int)
+    {
+        Fixed old = *this;
+        raw -= ONE;
+        return old;
+    }
+
+private:
+    int32_t raw;
+
+    constexpr Fixed(int32_t raw, int) : raw(raw) {}
+};
+
+constexpr Fixed operator+(Fixed a, Fixed b) { return Fixed::fromRaw(a.getRaw() + b.getRaw()); }
+constexpr Fixed operator-(Fixed a, Fixed b) { return Fixed::fromRaw(a.getRaw() - b.getRaw()); }
+constexpr Fixed operator-(Fixed a) { return Fixed::fromRaw(-a.getRaw()); }
+constexpr Fixed operator*(Fixed a, int b) { return Fixed::fromRaw(a.getRaw() * b); }
+constexpr Fixed operator*(int a, Fixed b) { return Fixed::fromRaw(a * b.getRaw()); }
+
+// Scaling by a floating-point value would truncate it to an integer
+Fixed operator*(Fixed a, float b) = delete;
+Fixed operator*(Fixed a, double b) = delete;
+Fixed operator*(float a, Fixed b) = delete;
+Fixed operator*(double a, Fixed b) = delete;
+
+constexpr bool operator==(Fixed a, Fixed b) { return a.getRaw() == b.getRaw(); }
+constexpr bool operator!=(Fixed a, Fixed b) { return a.getRaw() != b.getRaw(); }
+constexpr bool operator<(Fixed a, Fixed b) { return a.getRaw() < b.getRaw(); }
+constexpr bool operator<=(Fixed a, Fixed b) { return a.getRaw() <= b.getRaw(); }
+constexpr bool operator>(Fixed a, Fixed b) { return a.getRaw() > b.getRaw(); }
+constexpr bool operator>=(Fixed a, Fixed b) { return a.getRaw() >= b.getRaw(); }
+
+/**
+ * Get the absolute value of a fixed-point number.
+ */
+constexpr Fixed abs(Fixed value)
+{
+    return (value.getRaw() < 0) ? -value : value;
+}
+
+/**
+ * Interpolate linearly between two fixed-point numbers.
+ *
+ * @param t the interpolation factor, from 0 (giving from) to 1 (giving to).
+ */
+constexpr Fixed interpolate(Fixed from, Fixed to, Fixed t)
+{
+    return Fixed::fromRaw(from.getRaw() + static_cast<int32_t>(
+        static_cast<int64_t>(to.getRaw() - from.getRaw()) * t.getRaw() / Fixed::ONE
+    ));
+}
+
+#endif // FIXED_HPP
@@ -0,0 +1,126 @@
+#include <iomanip>
+#include <vector>
+
+#include "LatencyTracker.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Counts of latencies in buckets of LatencyTracker::BUCKET_WIDTH.
+ */
+struct LatencyHistogram
+{
+    const char* name;
+    int64_t count;
+    int64_t max; /**< Largest latency, in nanoseconds. */
+    std::vector<int64_t> buckets;
+
+    LatencyHistogram(const char* name) :
+        name(name),
+        count(0),
+        max(0),
+        buckets(LatencyTracker::BUCKET_COUNT, 0)
+    {
+    }
+
+    void add(Clock::duration latency)
+    {
+        int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+        int64_t bucket = nanoseconds / LatencyTracker::BUCKET_WIDTH;
+        if (bucket >= LatencyTracker::BUCKET_COUNT)
+        {
+            bucket = LatencyTracker::BUCKET_COUNT - 1;
+        }
+        buckets[bucket < 0 ? 0 : bucket]++;
+        if (nanoseconds > max)
+        {
+            max = nanoseconds;
+        }
+        count++;
+    }
+
+    /**
+     * Get the upper end of the bucket holding a percentile, in milliseconds.
+     */
+    double getPercentile(int percentile) const
+    {
+        int64_t rank = (count * percentile + 99) / 100;
+        int64_t seen = 0;
+        for (int i = 0; i < LatencyTracker::BUCKET_COUNT; i++)
+        {
+            seen += buckets[i];
+            if (seen >= rank)
+            {
+                return (i + 1) * LatencyTracker::BUCKET_WIDTH / 1e6;
+            }
+        }
+        return max / 1e6;
+    }
+};
+
+/**
+ * A reaction that has been simulated but not yet presented.
+ */
+struct SimulatedInput
+{
+    Clock::time_point inputTime;
+    Clock::time_point updateTime;
+};
+
+static std::vector<Clock::time_point> pendingInputs;
+static std::vector<SimulatedInput> simulatedInputs;
+static LatencyHistogram inputToUpdate("Input to update");
+static LatencyHistogram updateToPresent("Update to present");
+static LatencyHistogram inputToPresent("Input to present");
+
+void LatencyTracker::recordInput(Clock::time_point time)
+{
+    pendingInputs.push_back(time);
+}
+
+void LatencyTracker::recordPresent()
+{
+    Clock::time_point time = Clock::now();
+    for (auto& input : simulatedInputs)
+    {
+        updateToPresent.add(time - input.updateTime);
+        inputToPresent.add(time - input.inputTime);
+    }
+    simulatedInputs.clear();
+}
+
+void LatencyTracker::recordUpdate()
+{
+    Clock::time_point time = Clock::now();
+    for (auto inputTime : pendingInputs)
+    {
+        inputToUpdate.add(time - inputTime);
+        simulatedInputs.push_back({inputTime, time});
+    }
+    pendingInputs.clear();
+}
+
+void LatencyTracker::writeReport(std::ostream& out)
+{
+    // Leave the caller's stream formatted as it was
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << "Latency (ms):       count      p50      p99      max\n";
+    out << std::fixed << std::setprecision(1);
+    for (const LatencyHistogram* histogram : {&inputToUpdate, &updateToPresent, &inputToPresent})
+    {
+        out << std::left << std::setw(18) << histogram->name << std::right
+            << std::setw(8) << histogram->count;
+        if (histogram->count > 0)
+        {
+            out << std::setw(9) << histogram->getPercentile(50)
+                << std::setw(9) << histogram->getPercentile(99)
+                << std::setw(9) << histogram->max / 1e6;
+        }
+        out << '\n';
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,84 @@
+/**
+ * @file defines a tracker of input-to-photon latency
+ */
+#ifndef LATENCYTRACKER_HPP
+#define LATENCYTRACKER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * Measures the time from input to the frame that shows the game's reaction
+ * to it, and keeps histograms of the results.
+ *
+ * Inputs follow the game's pipeline: when an entity reacts to a button
+ * press, the press is recorded with the time the input manager saw it. The
+ * end of the next level update marks the reaction as simulated, and the
+ * next presented frame marks it as shown. Each stage is timed separately,
+ * so that delays can be pinned on input, simulation or presentation.
+ *
+ * Only used on the main thread. Latencies are only recorded when the program
+ * is built with JUMP_PROFILING defined; otherwise the LATENCY_ macros expand
+ * to nothing.
+ */
+class LatencyTracker
+{
+public:
+    /**
+     * The width of each histogram bucket, in nanoseconds.
+     */
+    static constexpr int64_t BUCKET_WIDTH = 100 * 1000;
+
+    /**
+     * The number of histogram buckets. Latencies beyond the last bucket are
+     * counted in it.
+     */
+    static constexpr int BUCKET_COUNT = 2000;
+
+    /**
+     * Record that the game has reacted to input.
+     *
+     * @param time when the input happened.
+     */
+    static void recordInput(std::chrono::steady_clock::time_point time);
+
+    /**
+     * Record that a frame was presented, showing all simulated reactions.
+     */
+    static void recordPresent();
+
+    /**
+     * Record that an update finished, simulating all recorded reactions.
+     */
+    static void recordUpdate();
+
+    /**
+     * Write the median, 99th percentile and maximum of each stage's
+     * latencies, in milliseconds.
+     */
+    static void writeReport(std::ostream& out);
+};
+
+#ifdef JUMP_PROFILING
+/**
+ * Record that the game has reacted to input that happened at a time.
+ */
+#define LATENCY_INPUT(time) LatencyTracker::recordInput(time)
+
+/**
+ * Record that a frame was presented.
+ */
+#define LATENCY_PRESENT() LatencyTracker::recordPresent()
+
+/**
+ * Record that an update finished.
+ */
+#define LATENCY_UPDATE() LatencyTracker::recordUpdate()
+#else
+#define LATENCY_INPUT(time)
+#define LATENCY_PRESENT()
+#define LATENCY_UPDATE()
+#endif
+
+#endif // LATENCYTRACKER_HPP
@@ -0,0 +1,111 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Profiler.hpp"
+
+/**
+ * A zone recorded by the profiler.
+ */
+struct ProfilerZone
+{
+    const char* name;
+    int64_t start;
+    int64_t end;
+};
+
+/**
+ * Ring buffer of the zones recorded by one thread.
+ *
+ * Only the owning thread writes zones. The count is published after each
+ * zone is written, so a dump from another thread sees complete zones,
+ * unless the owner wraps around onto them during the dump.
+ */
+struct ProfilerThreadBuffer
+{
+    int threadId;
+    std::atomic<uint64_t> count;
+    std::vector<ProfilerZone> zones;
+
+    ProfilerThreadBuffer(int threadId) :
+        threadId(threadId),
+        count(0),
+        zones(Profiler::ZONES_PER_THREAD)
+    {
+    }
+};
+
+/**
+ * The buffers of all threads that have recorded zones. Buffers outlive their
+ * threads, so that zones can still be dumped after a thread exits.
+ */
+static std::mutex buffersMutex;
+static std::vector<std::unique_ptr<ProfilerThreadBuffer>> buffers;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+/**
+ * Get the buffer of the calling thread, creating it on first use.
+ */
+static ProfilerThreadBuffer& getThreadBuffer()
+{
+    thread_local ProfilerThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffers.emplace_back(new ProfilerThreadBuffer(static_cast<int>(buffers.size()) + 1));
+        buffer = buffers.back().get();
+    }
+    return *buffer;
+}
+
+int64_t Profiler::getTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Profiler::recordZone(const char* name, int64_t start, int64_t end)
+{
+    ProfilerThreadBuffer& buffer = getThreadBuffer();
+    uint64_t count = buffer.count.load(std::memory_order_relaxed);
+    ProfilerZone& zone = buffer.zones[count % ZONES_PER_THREAD];
+    zone.name = name;
+    zone.start = start;
+    zone.end = end;
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+bool Profiler::writeChromeTrace(const char* path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    // Complete ("X") events, with times in microseconds
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\":[";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (auto& buffer : buffers)
+    {
+        uint64_t count = buffer->count.load(std::memory_order_acquire);
+        uint64_t begin = (count > ZONES_PER_THREAD) ? count - ZONES_PER_THREAD : 0;
+        for (uint64_t i = begin; i < count; i++)
+        {
+            const ProfilerZone& zone = buffer->zones[i % ZONES_PER_THREAD];
+            file << (first ? "\n" : ",\n");
+            file << "{\"name\":\"" << zone.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"ts\":" << zone.start / 1000.0 << ",\"dur\":" << (zone.end - zone.start) / 1000.0 << '}';
+            first = false;
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file defines a scoped zone profiler with Chrome trace export
+ */
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <cstdint>
+
+/**
+ * Records timed zones of code on every thread, for viewing in
+ * chrome://tracing or Perfetto.
+ *
+ * Each thread records into its own ring buffer, so recording never blocks
+ * and only the most recent zones of each thread are kept. Zones are only
+ * recorded when the program is built with JUMP_PROFILING defined; otherwise
+ * PROFILE_ZONE() expands to nothing.
+ */
+class Profiler
+{
+public:
+    /**
+     * The number of zones kept for each thread.
+     */
+    static constexpr int ZONES_PER_THREAD = 1 << 16;
+
+    /**
+     * The file that the game writes its trace to, on exit or when F12 is pressed.
+     */
+    static constexpr const char* TRACE_PATH = "profile.json";
+
+    /**
+     * Get the current time, in nanoseconds since the profiler was started.
+     */
+    static int64_t getTime();
+
+    /**
+     * Record a zone that finished on the calling thread.
+     *
+     * @param name the name of the zone. Must be a string literal.
+     * @param start the start time of the zone, from getTime().
+     * @param end the end time of the zone, from getTime().
+     */
+    static void recordZone(const char* name, int64_t start, int64_t end);
+
+    /**
+     * Write all recorded zones to a file in the Chrome trace event format.
+     *
+     * @return true if the file was written.
+     */
+    static bool writeChromeTrace(const char* path);
+};
+
+/**
+ * Records the lifetime of the object as a profiler zone.
+ */
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name) :
+        name(name),
+        start(Profiler::getTime())
+    {
+    }
+
+    ~ProfileZone()
+    {
+        Profiler::recordZone(name, start, Profiler::getTime());
+    }
+
+private:
+    const char* name;
+    int64_t start;
+};
+
+#define PROFILE_CONCATENATE_IMPL(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_IMPL(a, b)
+
+#ifdef JUMP_PROFILING
+/**
+ * Profile the rest of the enclosing scope as a zone with the given name.
+ */
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCATENATE(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
+
+#endif // PROFILER_HPP
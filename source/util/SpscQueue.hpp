@@ -0,0 +1,99 @@
+/**
+ * @file defines a lock-free queue for passing items between two threads
+ */
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * A fixed-capacity, lock-free queue with a single producer thread and a
+ * single consumer thread.
+ *
+ * Only the producer may call push(), and only the consumer may call front()
+ * and pop().
+ *
+ * @tparam T the type of the items, which must be copy-assignable.
+ * @tparam CAPACITY the largest number of items in the queue, as a power of two.
+ */
+template <typename T, size_t CAPACITY>
+class SpscQueue
+{
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue();
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * Get the oldest item in the queue without removing it.
+     *
+     * @return the item, or nullptr if the queue is empty.
+     */
+    const T* front() const;
+
+    /**
+     * Remove the oldest item from the queue, which must not be empty.
+     */
+    void pop();
+
+    /**
+     * Add an item to the queue.
+     *
+     * @return false if the queue is full, in which case the item is not added.
+     */
+    bool push(const T& item);
+
+private:
+    // The indices only ever increase, and are wrapped when indexing items.
+    // They are kept on separate cache lines so that the threads don't
+    // contend for them.
+    alignas(64) std::atomic<size_t> head; /**< Index of the oldest item, written by the consumer. */
+    alignas(64) std::atomic<size_t> tail; /**< Index after the newest item, written by the producer. */
+    T items[CAPACITY];
+};
+
+template <typename T, size_t CAPACITY>
+SpscQueue<T, CAPACITY>::SpscQueue() :
+    head(0),
+    tail(0)
+{
+}
+
+template <typename T, size_t CAPACITY>
+const T* SpscQueue<T, CAPACITY>::front() const
+{
+    size_t index = head.load(std::memory_order_relaxed);
+    if (index == tail.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+    return &items[index & (CAPACITY - 1)];
+}
+
+template <typename T, size_t CAPACITY>
+void SpscQueue<T, CAPACITY>::pop()
+{
+    // Release the item's slot only after it has been read
+    head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template <typename T, size_t CAPACITY>
+bool SpscQueue<T, CAPACITY>::push(const T& item)
+{
+    size_t index = tail.load(std::memory_order_relaxed);
+    if (index - head.load(std::memory_order_acquire) == CAPACITY)
+    {
+        return false;
+    }
+    items[index & (CAPACITY - 1)] = item;
+
+    // Publish the item only after it has been written
+    tail.store(index + 1, std::memory_order_release);
+    return true;
+}
+
+#endif // SPSCQUEUE_HPP
@@ -4,20 +4,21 @@
 #ifndef UTIL_HPP
 #define UTIL_HPP
 
+#include "Fixed.hpp"
+
 /**
  * Takes a hex value in the format 0xABCD where
  *  - A is tiles
  *  - B is pixels
  *  - C is subpixels
  *  - D is subsubpixels
- * and converts it to a float usable by our game engine (where the units are pixels)
+ * and converts it to a fixed-point value usable by our game engine (where the units are pixels)
+ *
+ * Since a tile is 16 pixels, the hex value is exactly the raw 24.8 fixed-point representation.
  */
-constexpr float physicsValueFromHex(int value)
+constexpr Fixed physicsValueFromHex(int value)
 {
-    return 16.0f * ((value & 0xf000) >> 12) +
-           (float)((value & 0xf00) >> 8) +
-           0.0625f * ((value & 0xf0) >> 4) +
-           0.00390625f * (float)(value & 0xf);
+    return Fixed::fromRaw(value);
 }
 
 /**
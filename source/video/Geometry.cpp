@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <climits>
+
+#include "Geometry.hpp"
+
+Geometry::Geometry() :
+    left(INT_MAX),
+    top(INT_MAX),
+    right(INT_MIN),
+    bottom(INT_MIN)
+{
+}
+
+void Geometry::addLine(int x0, int y0, int x1, int y1, unsigned color)
+{
+    addVertex(x0, y0, color);
+    addVertex(x1, y1, color);
+}
+
+void Geometry::addRectangle(int x, int y, int width, int height, unsigned color)
+{
+    addLine(x, y, x + width, y, color);
+    addLine(x + width, y, x + width, y + height, color);
+    addLine(x + width, y + height, x, y + height, color);
+    addLine(x, y + height, x, y, color);
+}
+
+void Geometry::addTriangle(int x0, int y0, int x1, int y1, int x2, int y2, unsigned color)
+{
+    addLine(x0, y0, x1, y1, color);
+    addLine(x1, y1, x2, y2, color);
+    addLine(x2, y2, x0, y0, color);
+}
+
+void Geometry::addVertex(int x, int y, unsigned color)
+{
+    uint8_t r = (color >> 16) & 0xff;
+    uint8_t g = (color >> 8) & 0xff;
+    uint8_t b = color & 0xff;
+    uint8_t a = (color >> 24) & 0xff;
+    if (a == 0 && (r != 0 || g != 0 || b != 0))
+    {
+        a = 0xff;
+    }
+    Vertex vertex = {static_cast<float>(x), static_cast<float>(y), {r, g, b, a}};
+    lineVertices.push_back(vertex);
+
+    left = std::min(left, x);
+    top = std::min(top, y);
+    right = std::max(right, x);
+    bottom = std::max(bottom, y);
+}
+
+void Geometry::clear()
+{
+    lineVertices.clear();
+    left = INT_MAX;
+    top = INT_MAX;
+    right = INT_MIN;
+    bottom = INT_MIN;
+}
+
+int Geometry::getBottom() const
+{
+    return bottom;
+}
+
+int Geometry::getLeft() const
+{
+    return left;
+}
+
+const std::vector<Geometry::Vertex>& Geometry::getLineVertices() const
+{
+    return lineVertices;
+}
+
+int Geometry::getRight() const
+{
+    return right;
+}
+
+int Geometry::getTop() const
+{
+    return top;
+}
+
+bool Geometry::isEmpty() const
+{
+    return lineVertices.empty();
+}
@@ -0,0 +1,96 @@
+#ifndef GEOMETRY_HPP
+#define GEOMETRY_HPP
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * A retained set of colored primitives, built once and drawn many times
+ * through VideoManager::drawGeometry().
+ */
+class Geometry
+{
+public:
+    /**
+     * A vertex of a primitive.
+     */
+    struct Vertex
+    {
+        float x;
+        float y;
+        uint8_t color[4]; /**< RGBA color. */
+    };
+
+    Geometry();
+
+    /**
+     * Add a line.
+     *
+     * @param color the color, as a 32-bit ARGB value (see VideoManager::setColor()).
+     */
+    void addLine(int x0, int y0, int x1, int y1, unsigned color);
+
+    /**
+     * Add the outline of a rectangle.
+     *
+     * @param x the left coordinate.
+     * @param y the top coordinate.
+     * @param width the width of the rectangle.
+     * @param height the height of the rectangle.
+     * @param color the color, as a 32-bit ARGB value (see VideoManager::setColor()).
+     */
+    void addRectangle(int x, int y, int width, int height, unsigned color);
+
+    /**
+     * Add the outline of a triangle.
+     *
+     * @param color the color, as a 32-bit ARGB value (see VideoManager::setColor()).
+     */
+    void addTriangle(int x0, int y0, int x1, int y1, int x2, int y2, unsigned color);
+
+    /**
+     * Remove all primitives, keeping the allocated memory.
+     */
+    void clear();
+
+    /**
+     * Get the bottom y coordinate of the bounding box of all primitives.
+     */
+    int getBottom() const;
+
+    /**
+     * Get the left x coordinate of the bounding box of all primitives.
+     */
+    int getLeft() const;
+
+    /**
+     * Get the vertices of all lines, two per line.
+     */
+    const std::vector<Vertex>& getLineVertices() const;
+
+    /**
+     * Get the right x coordinate of the bounding box of all primitives.
+     */
+    int getRight() const;
+
+    /**
+     * Get the top y coordinate of the bounding box of all primitives.
+     */
+    int getTop() const;
+
+    /**
+     * Check if the geometry has no primitives.
+     */
+    bool isEmpty() const;
+
+private:
+    std::vector<Vertex> lineVertices;
+    int left;
+    int top;
+    int right;
+    int bottom;
+
+    void addVertex(int x, int y, unsigned color);
+};
+
+#endif // GEOMETRY_HPP
@@ -1,6 +1,8 @@
 #ifndef VIDEOMANAGER_HPP
 #define VIDEOMANAGER_HPP
 
+class Geometry;
+
 /**
  * Interface for graphical routines.
  */
@@ -14,6 +16,15 @@ public:
      */
     virtual void clearScreen()=0;
 
+    /**
+     * Draw retained geometry.
+     *
+     * @param geometry the geometry to draw.
+     * @param x the x offset to draw the geometry at.
+     * @param y the y offset to draw the geometry at.
+     */
+    virtual void drawGeometry(const Geometry& geometry, int x, int y)=0;
+
     /**
      * Draw a line.
      */
@@ -0,0 +1,45 @@
+#include "NullVideoManager.hpp"
+
+NullVideoManager::NullVideoManager(int screenWidth, int screenHeight) :
+    screenWidth(screenWidth),
+    screenHeight(screenHeight)
+{
+}
+
+void NullVideoManager::clearScreen()
+{
+}
+
+void NullVideoManager::drawGeometry(const Geometry& geometry, int x, int y)
+{
+}
+
+void NullVideoManager::drawLine(int x0, int y0, int x1, int y1)
+{
+}
+
+void NullVideoManager::drawRectangle(int x, int y, int width, int height)
+{
+}
+
+void NullVideoManager::drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2)
+{
+}
+
+int NullVideoManager::getScreenHeight() const
+{
+    return screenHeight;
+}
+
+int NullVideoManager::getScreenWidth() const
+{
+    return screenWidth;
+}
+
+void NullVideoManager::setColor(unsigned color)
+{
+}
+
+void NullVideoManager::updateScreen()
+{
+}
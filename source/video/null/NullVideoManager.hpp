@@ -0,0 +1,35 @@
+#ifndef NULLVIDEOMANAGER_HPP
+#define NULLVIDEOMANAGER_HPP
+
+#include "../VideoManager.hpp"
+
+/**
+ * Graphics system that draws nothing, for running without a display.
+ */
+class NullVideoManager : public VideoManager
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param screenWidth the width of the virtual screen, in pixels.
+     * @param screenHeight the height of the virtual screen, in pixels.
+     */
+    NullVideoManager(int screenWidth, int screenHeight);
+
+    void clearScreen();
+    void drawGeometry(const Geometry& geometry, int x, int y);
+    void drawLine(int x0, int y0, int x1, int y1);
+    void drawRectangle(int x, int y, int width, int height);
+    void drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2);
+    int getScreenHeight() const;
+    int getScreenWidth() const;
+    void setColor(unsigned color);
+    void updateScreen();
+
+private:
+    int screenWidth;
+    int screenHeight;
+};
+
+#endif // NULLVIDEOMANAGER_HPP
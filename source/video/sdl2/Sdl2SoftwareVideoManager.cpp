@@ -0,0 +1,51 @@
+#include <stdexcept>
+#include <string>
+
+#include "../../util/LatencyTracker.hpp"
+#include "../../util/Profiler.hpp"
+
+#include "Sdl2SoftwareVideoManager.hpp"
+
+Sdl2SoftwareVideoManager::Sdl2SoftwareVideoManager(SDL_Window* window, int virtualScreenWidth, int virtualScreenHeight) :
+    SoftwareVideoManager(virtualScreenWidth, virtualScreenHeight),
+    renderer(nullptr),
+    texture(nullptr)
+{
+    renderer = SDL_CreateRenderer(window, -1, 0);
+    if (renderer == nullptr)
+    {
+        throw std::runtime_error(std::string("Failed to create the SDL_Renderer: ") + SDL_GetError());
+    }
+
+    // Scale the virtual screen up to the window
+    SDL_RenderSetLogicalSize(renderer, virtualScreenWidth, virtualScreenHeight);
+
+    texture = SDL_CreateTexture(
+        renderer,
+        SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING,
+        virtualScreenWidth,
+        virtualScreenHeight
+    );
+    if (texture == nullptr)
+    {
+        SDL_DestroyRenderer(renderer);
+        throw std::runtime_error(std::string("Failed to create the SDL_Texture: ") + SDL_GetError());
+    }
+}
+
+Sdl2SoftwareVideoManager::~Sdl2SoftwareVideoManager()
+{
+    SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(renderer);
+}
+
+void Sdl2SoftwareVideoManager::updateScreen()
+{
+    PROFILE_ZONE("Sdl2SoftwareVideoManager::updateScreen");
+    SDL_UpdateTexture(texture, nullptr, getPixels(), getScreenWidth() * sizeof(uint32_t));
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+    SDL_RenderPresent(renderer);
+    LATENCY_PRESENT();
+}
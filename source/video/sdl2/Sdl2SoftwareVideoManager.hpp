@@ -0,0 +1,32 @@
+#ifndef SDL2SOFTWAREVIDEOMANAGER_HPP
+#define SDL2SOFTWAREVIDEOMANAGER_HPP
+
+#include <SDL2/SDL.h>
+
+#include "../software/SoftwareVideoManager.hpp"
+
+/**
+ * Graphics system that rasterizes in software and presents the framebuffer
+ * through an SDL2 texture, for machines without usable OpenGL drivers.
+ */
+class Sdl2SoftwareVideoManager : public SoftwareVideoManager
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param window the window to render to. Must not have an OpenGL context.
+     * @param virtualScreenWidth the width of the virtual screen, in pixels.
+     * @param virtualScreenHeight the height of the virtual screen, in pixels.
+     */
+    Sdl2SoftwareVideoManager(SDL_Window* window, int virtualScreenWidth, int virtualScreenHeight);
+    ~Sdl2SoftwareVideoManager();
+
+    void updateScreen();
+
+private:
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+};
+
+#endif // SDL2SOFTWAREVIDEOMANAGER_HPP
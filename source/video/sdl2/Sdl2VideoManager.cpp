@@ -1,11 +1,15 @@
 #include <SDL2/SDL_opengl.h>
 
+#include "../../util/LatencyTracker.hpp"
+#include "../../util/Profiler.hpp"
+
 #include "Sdl2VideoManager.hpp"
 
 Sdl2VideoManager::Sdl2VideoManager(SDL_Window* window, int virtualScreenWidth, int virtualScreenHeight) :
     window(window),
     screenWidth(virtualScreenWidth),
-    screenHeight(virtualScreenHeight)
+    screenHeight(virtualScreenHeight),
+    color(0xffffffff)
 {
 }
 
@@ -21,31 +25,54 @@ void Sdl2VideoManager::clearScreen()
     glLoadIdentity();
 }
 
+void Sdl2VideoManager::drawGeometry(const Geometry& geometry, int x, int y)
+{
+    // Keep the draw order by drawing anything batched before this first
+    flush();
+
+    glPushMatrix();
+    glTranslatef(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    drawLines(geometry);
+    glPopMatrix();
+}
+
 void Sdl2VideoManager::drawLine(int x0, int y0, int x1, int y1)
 {
-    glBegin(GL_LINES);
-        glVertex2i(x0, y0);
-        glVertex2i(x1, y1);
-    glEnd();
+    batch.addLine(x0, y0, x1, y1, color);
+}
+
+void Sdl2VideoManager::drawLines(const Geometry& geometry)
+{
+    const std::vector<Geometry::Vertex>& vertices = geometry.getLineVertices();
+    if (vertices.empty())
+    {
+        return;
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(Geometry::Vertex), &vertices[0].x);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Geometry::Vertex), vertices[0].color);
+    glDrawArrays(GL_LINES, 0, vertices.size());
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 void Sdl2VideoManager::drawRectangle(int x, int y, int width, int height)
 {
-    glBegin(GL_LINE_LOOP);
-        glVertex2i(x, y);
-        glVertex2i(x + width, y);
-        glVertex2i(x + width, y + height);
-        glVertex2i(x, y + height);
-    glEnd();
+    batch.addRectangle(x, y, width, height, color);
 }
 
 void Sdl2VideoManager::drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2)
 {
-    glBegin(GL_LINE_LOOP);
-        glVertex2i(x0, y0);
-        glVertex2i(x1, y1);
-        glVertex2i(x2, y2);
-    glEnd();
+    batch.addTriangle(x0, y0, x1, y1, x2, y2, color);
+}
+
+void Sdl2VideoManager::flush()
+{
+    // Draw every line batched so far in one call, keeping the memory for the next batch
+    drawLines(batch);
+    batch.clear();
 }
 
 int Sdl2VideoManager::getScreenHeight() const
@@ -60,18 +87,13 @@ int Sdl2VideoManager::getScreenWidth() const
 
 void Sdl2VideoManager::setColor(unsigned color)
 {
-    Uint8 r = (color >> 16) & 0xff;
-    Uint8 g = (color >> 8) & 0xff;
-    Uint8 b = color & 0xff;
-    Uint8 a = (color >> 24) & 0xff;
-    if (a == 0 && (r != 0 || g != 0 || b != 0))
-    {
-        a = 0xff;
-    }
-    glColor4ub(r, g, b, a);
+    this->color = color;
 }
 
 void Sdl2VideoManager::updateScreen()
 {
+    PROFILE_ZONE("Sdl2VideoManager::updateScreen");
+    flush();
     SDL_GL_SwapWindow(window);
+    LATENCY_PRESENT();
 }
@@ -3,10 +3,14 @@
 
 #include <SDL2/SDL.h>
 
+#include "../Geometry.hpp"
 #include "../VideoManager.hpp"
 
 /**
  * Graphics system powered by SDL2/OpenGL.
+ *
+ * Primitives are collected into a vertex array over the frame and drawn
+ * together when the screen is updated.
  */
 class Sdl2VideoManager : public VideoManager
 {
@@ -21,6 +25,7 @@ public:
     Sdl2VideoManager(SDL_Window* window, int virtualScreenWidth, int virtualScreenHeight);
 
     void clearScreen();
+    void drawGeometry(const Geometry& geometry, int x, int y);
     void drawLine(int x0, int y0, int x1, int y1);
     void drawRectangle(int x, int y, int width, int height);
     void drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2);
@@ -33,6 +38,11 @@ private:
     SDL_Window* window;
     int screenWidth;
     int screenHeight;
+    unsigned color; /**< Current ARGB drawing color. */
+    Geometry batch; /**< Primitives drawn since the last flush. */
+
+    void drawLines(const Geometry& geometry);
+    void flush();
 };
 
 #endif // SDL2GRAPHICSMANAGER_HPP
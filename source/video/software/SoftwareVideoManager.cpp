@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "../Geometry.hpp"
+
+#include "SoftwareVideoManager.hpp"
+
+/**
+ * Convert a color given to VideoManager::setColor() to the framebuffer format.
+ */
+static uint32_t toPixel(unsigned color)
+{
+    if ((color & 0xff000000) == 0 && (color & 0x00ffffff) != 0)
+    {
+        color |= 0xff000000;
+    }
+    return color;
+}
+
+SoftwareVideoManager::SoftwareVideoManager(int screenWidth, int screenHeight) :
+    screenWidth(screenWidth),
+    screenHeight(screenHeight),
+    color(0xffffffff),
+    pixels(screenWidth * screenHeight, 0xff000000)
+{
+}
+
+void SoftwareVideoManager::clearScreen()
+{
+    std::fill(pixels.begin(), pixels.end(), 0xff000000);
+}
+
+void SoftwareVideoManager::drawGeometry(const Geometry& geometry, int x, int y)
+{
+    const std::vector<Geometry::Vertex>& vertices = geometry.getLineVertices();
+    for (size_t i = 0; i + 1 < vertices.size(); i += 2)
+    {
+        const Geometry::Vertex& start = vertices[i];
+        const Geometry::Vertex& end = vertices[i + 1];
+        uint32_t vertexColor = (static_cast<uint32_t>(start.color[3]) << 24) | (start.color[0] << 16) | (start.color[1] << 8) | start.color[2];
+        drawLine(
+            static_cast<int>(start.x) + x, static_cast<int>(start.y) + y,
+            static_cast<int>(end.x) + x, static_cast<int>(end.y) + y,
+            vertexColor
+        );
+    }
+}
+
+void SoftwareVideoManager::drawLine(int x0, int y0, int x1, int y1)
+{
+    drawLine(x0, y0, x1, y1, color);
+}
+
+void SoftwareVideoManager::drawLine(int x0, int y0, int x1, int y1, uint32_t color)
+{
+    // Axis-aligned lines (nearly all of them) are filled as spans
+    if (y0 == y1)
+    {
+        if (x0 < x1)
+        {
+            fillRow(x0, x1 - 1, y0, color);
+        }
+        else if (x0 > x1)
+        {
+            fillRow(x1 + 1, x0, y0, color);
+        }
+        return;
+    }
+    if (x0 == x1)
+    {
+        if (y0 < y1)
+        {
+            fillColumn(x0, y0, y1 - 1, color);
+        }
+        else
+        {
+            fillColumn(x0, y1 + 1, y0, color);
+        }
+        return;
+    }
+
+    // Skip lines that are entirely off the screen
+    if (std::max(x0, x1) < 0 || std::min(x0, x1) >= screenWidth ||
+        std::max(y0, y1) < 0 || std::min(y0, y1) >= screenHeight)
+    {
+        return;
+    }
+
+    // Bresenham's algorithm, stopping before the last point
+    int dx = std::abs(x1 - x0);
+    int dy = -std::abs(y1 - y0);
+    int stepX = (x0 < x1) ? 1 : -1;
+    int stepY = (y0 < y1) ? 1 : -1;
+    int error = dx + dy;
+    int x = x0;
+    int y = y0;
+    while (x != x1 || y != y1)
+    {
+        if (x >= 0 && x < screenWidth && y >= 0 && y < screenHeight)
+        {
+            pixels[y * screenWidth + x] = color;
+        }
+        int doubleError = 2 * error;
+        if (doubleError >= dy)
+        {
+            error += dy;
+            x += stepX;
+        }
+        if (doubleError <= dx)
+        {
+            error += dx;
+            y += stepY;
+        }
+    }
+}
+
+void SoftwareVideoManager::drawRectangle(int x, int y, int width, int height)
+{
+    drawLine(x, y, x + width, y, color);
+    drawLine(x + width, y, x + width, y + height, color);
+    drawLine(x + width, y + height, x, y + height, color);
+    drawLine(x, y + height, x, y, color);
+}
+
+void SoftwareVideoManager::drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2)
+{
+    drawLine(x0, y0, x1, y1, color);
+    drawLine(x1, y1, x2, y2, color);
+    drawLine(x2, y2, x0, y0, color);
+}
+
+void SoftwareVideoManager::fillColumn(int x, int top, int bottom, uint32_t color)
+{
+    if (x < 0 || x >= screenWidth)
+    {
+        return;
+    }
+    top = std::max(top, 0);
+    bottom = std::min(bottom, screenHeight - 1);
+    for (int y = top; y <= bottom; y++)
+    {
+        pixels[y * screenWidth + x] = color;
+    }
+}
+
+void SoftwareVideoManager::fillRow(int left, int right, int y, uint32_t color)
+{
+    if (y < 0 || y >= screenHeight)
+    {
+        return;
+    }
+    left = std::max(left, 0);
+    right = std::min(right, screenWidth - 1);
+
+    uint32_t* pixel = &pixels[y * screenWidth] + left;
+    int count = right - left + 1;
+#ifdef __SSE2__
+    // Four pixels at a time
+    __m128i colors = _mm_set1_epi32(static_cast<int>(color));
+    for (; count >= 4; count -= 4, pixel += 4)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixel), colors);
+    }
+#endif
+    for (; count > 0; count--)
+    {
+        *pixel++ = color;
+    }
+}
+
+uint32_t SoftwareVideoManager::getPixel(int x, int y) const
+{
+    return pixels[y * screenWidth + x];
+}
+
+const uint32_t* SoftwareVideoManager::getPixels() const
+{
+    return pixels.data();
+}
+
+int SoftwareVideoManager::getScreenHeight() const
+{
+    return screenHeight;
+}
+
+int SoftwareVideoManager::getScreenWidth() const
+{
+    return screenWidth;
+}
+
+bool SoftwareVideoManager::saveImage(const char* path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "P6\n" << screenWidth << ' ' << screenHeight << "\n255\n";
+    std::vector<char> row(screenWidth * 3);
+    for (int y = 0; y < screenHeight; y++)
+    {
+        for (int x = 0; x < screenWidth; x++)
+        {
+            uint32_t pixel = pixels[y * screenWidth + x];
+            row[x * 3] = static_cast<char>((pixel >> 16) & 0xff);
+            row[x * 3 + 1] = static_cast<char>((pixel >> 8) & 0xff);
+            row[x * 3 + 2] = static_cast<char>(pixel & 0xff);
+        }
+        file.write(row.data(), row.size());
+    }
+
+    return static_cast<bool>(file);
+}
+
+void SoftwareVideoManager::setColor(unsigned color)
+{
+    this->color = toPixel(color);
+}
+
+void SoftwareVideoManager::updateScreen()
+{
+}
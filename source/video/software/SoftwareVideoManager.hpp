@@ -0,0 +1,68 @@
+#ifndef SOFTWAREVIDEOMANAGER_HPP
+#define SOFTWAREVIDEOMANAGER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "../VideoManager.hpp"
+
+/**
+ * Graphics system that rasterizes into a framebuffer in memory, without a GPU.
+ *
+ * Pixels are 32-bit ARGB values, stored row by row. Lines cover the pixels
+ * from their first point up to, but not including, their second point, so
+ * that connected lines don't overlap (as in OpenGL). Rectangles and triangles
+ * are drawn as outlines made of such lines, like the other video managers.
+ */
+class SoftwareVideoManager : public VideoManager
+{
+public:
+    /**
+     * Constructor.
+     *
+     * @param screenWidth the width of the framebuffer, in pixels.
+     * @param screenHeight the height of the framebuffer, in pixels.
+     */
+    SoftwareVideoManager(int screenWidth, int screenHeight);
+
+    void clearScreen();
+    void drawGeometry(const Geometry& geometry, int x, int y);
+    void drawLine(int x0, int y0, int x1, int y1);
+    void drawRectangle(int x, int y, int width, int height);
+    void drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2);
+
+    /**
+     * Get the color of a pixel, as a 32-bit ARGB value.
+     */
+    uint32_t getPixel(int x, int y) const;
+
+    /**
+     * Get the framebuffer, with getScreenWidth() pixels per row.
+     */
+    const uint32_t* getPixels() const;
+
+    int getScreenHeight() const;
+    int getScreenWidth() const;
+
+    /**
+     * Save the framebuffer to a binary PPM image file.
+     *
+     * @return true if the file was written.
+     */
+    bool saveImage(const char* path) const;
+
+    void setColor(unsigned color);
+    void updateScreen();
+
+private:
+    int screenWidth;
+    int screenHeight;
+    uint32_t color; /**< Current ARGB drawing color. */
+    std::vector<uint32_t> pixels;
+
+    void drawLine(int x0, int y0, int x1, int y1, uint32_t color);
+    void fillColumn(int x, int top, int bottom, uint32_t color);
+    void fillRow(int left, int right, int y, uint32_t color);
+};
+
+#endif // SOFTWAREVIDEOMANAGER_HPP